@@ -0,0 +1,37 @@
+#include "camadas.h"
+#include <string.h>
+
+void camada_init(camada_t *camada) {
+    memset(camada, 0, sizeof(*camada));
+    camada->alvo.width = CAMADA_LARGURA;
+    camada->alvo.height = CAMADA_ALTURA;
+    camada->alvo.pages = CAMADA_ALTURA / 8;
+    camada->alvo.bufsize = CAMADA_BYTES + 1;
+    // O byte de controle fica no fim da palavra 0, assim os pixels começam alinhados
+    camada->alvo.ram_buffer = (uint8_t *)&camada->memoria[1] - 1;
+    camada->alvo.ram_buffer[0] = 0x40;
+}
+
+void camada_limpar(camada_t *camada) {
+    memset(&camada->memoria[1], 0, CAMADA_BYTES);
+}
+
+const uint32_t *camada_pixels(const camada_t *camada) {
+    return &camada->memoria[1];
+}
+
+void camadas_compor(ssd1306_t *tela, camada_t *const camadas[], uint8_t quantidade) {
+    if (tela->ram_buffer == NULL || tela->bufsize != CAMADA_BYTES + 1) {
+        return;
+    }
+
+    // Os framebuffers estáticos deixam os pixels alinhados em 4 bytes
+    uint32_t *destino = (uint32_t *)(tela->ram_buffer + 1);
+    for (uint16_t i = 0; i < CAMADA_PALAVRAS; i++) {
+        uint32_t palavra = 0;
+        for (uint8_t c = 0; c < quantidade; c++) {
+            palavra |= camadas[c]->memoria[1 + i];
+        }
+        destino[i] = palavra;
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef CAMADAS_H
+#define CAMADAS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+
+// Geometria fixa das camadas (igual à do display)
+#define CAMADA_LARGURA SSD1306_LARGURA
+#define CAMADA_ALTURA SSD1306_ALTURA
+#define CAMADA_BYTES (CAMADA_LARGURA * CAMADA_ALTURA / 8)
+#define CAMADA_PALAVRAS (CAMADA_BYTES / 4)
+
+// Camada de 1 bpp no mesmo formato de páginas do SSD1306.
+// O campo alvo permite desenhar com as funções ssd1306_* normais.
+typedef struct {
+    ssd1306_t alvo;
+    uint32_t memoria[CAMADA_PALAVRAS + 1]; // Palavra 0 reservada para o byte de controle
+} camada_t;
+
+void camada_init(camada_t *camada);
+void camada_limpar(camada_t *camada);
+const uint32_t *camada_pixels(const camada_t *camada);
+
+// Combina as camadas com OR palavra a palavra no buffer da tela
+void camadas_compor(ssd1306_t *tela, camada_t *const camadas[], uint8_t quantidade);
+
+#endif // CAMADAS_H
@@ -84,5 +84,6 @@ static uint8_t font[] = {
     0x07, 0x04, 0x07, 0x05, 0x07, // 6
     0x07, 0x01, 0x02, 0x02, 0x02, // 7
     0x07, 0x05, 0x07, 0x05, 0x07, // 8
-    0x07, 0x05, 0x07, 0x01, 0x07  // 9
+    0x07, 0x05, 0x07, 0x01, 0x07, // 9
+    0x00, 0x00, 0x00, 0x19, 0x26, 0x00, 0x00, 0x00  // ~ (aproximado)
 };
@@ -0,0 +1,112 @@
+#ifndef FRAMEBUFFER_HPP
+#define FRAMEBUFFER_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+// Framebuffer monocromático no formato de páginas do SSD1306 com geometria fixa
+// em tempo de compilação. A memória começa com 3 bytes livres e o byte de
+// controle 0x40, assim os pixels ficam alinhados em 4 bytes e o buffer inteiro
+// pode ser enviado em uma única transação I2C.
+template <uint8_t W, uint8_t H>
+class Framebuffer {
+public:
+    static_assert(W > 0 && H > 0 && H % 8 == 0, "altura deve ser múltipla de 8");
+
+    static constexpr uint8_t largura = W;
+    static constexpr uint8_t altura = H;
+    static constexpr uint8_t paginas = H / 8;
+    static constexpr uint16_t bytes = W * paginas;
+
+    uint8_t *ram_buffer() {
+        memoria[3] = 0x40; // Co = 0, D/C = 1
+        return &memoria[3];
+    }
+
+    uint8_t *pixels() { return &memoria[4]; }
+
+    static inline bool dentro(int x, int y) {
+        return (unsigned)x < W && (unsigned)y < H;
+    }
+
+    static inline void pixel(uint8_t *px, int x, int y, bool value) {
+        if (!dentro(x, y)) return;
+        uint8_t *byte = &px[((unsigned)y / 8) * W + (unsigned)x];
+        uint8_t mascara = 1u << ((unsigned)y % 8);
+        if (value) {
+            *byte |= mascara;
+        } else {
+            *byte &= ~mascara;
+        }
+    }
+
+    static inline void fill(uint8_t *px, bool value) {
+        memset(px, value ? 0xFF : 0x00, bytes);
+    }
+
+    static inline void hline(uint8_t *px, int x0, int x1, int y, bool value) {
+        if ((unsigned)y >= H) return;
+        if (x0 < 0) x0 = 0;
+        if (x1 >= W) x1 = W - 1;
+        uint8_t *byte = &px[((unsigned)y / 8) * W];
+        uint8_t mascara = 1u << ((unsigned)y % 8);
+        for (int x = x0; x <= x1; ++x) {
+            if (value) {
+                byte[x] |= mascara;
+            } else {
+                byte[x] &= ~mascara;
+            }
+        }
+    }
+
+    // Preenche a coluna byte a byte em vez de pixel a pixel
+    static inline void vline(uint8_t *px, int x, int y0, int y1, bool value) {
+        if ((unsigned)x >= W) return;
+        if (y0 < 0) y0 = 0;
+        if (y1 >= H) y1 = H - 1;
+        while (y0 <= y1) {
+            unsigned pagina = (unsigned)y0 / 8;
+            unsigned fim = (unsigned)y1 / 8 == pagina ? (unsigned)y1 % 8 : 7;
+            uint8_t mascara = (uint8_t)((0xFFu << ((unsigned)y0 % 8)) & (0xFFu >> (7 - fim)));
+            uint8_t *byte = &px[pagina * W + (unsigned)x];
+            if (value) {
+                *byte |= mascara;
+            } else {
+                *byte &= ~mascara;
+            }
+            y0 = (int)(pagina * 8 + 8);
+        }
+    }
+
+    static inline void rect(uint8_t *px, int top, int left, int width, int height, bool value, bool fill) {
+        if (width <= 0 || height <= 0) return;
+        hline(px, left, left + width - 1, top, value);
+        hline(px, left, left + width - 1, top + height - 1, value);
+        vline(px, left, top, top + height - 1, value);
+        vline(px, left + width - 1, top, top + height - 1, value);
+        if (fill) {
+            for (int x = left + 1; x < left + width - 1; ++x) {
+                vline(px, x, top + 1, top + height - 2, value);
+            }
+        }
+    }
+
+    static inline void line(uint8_t *px, int x0, int y0, int x1, int y1, bool value) {
+        int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+        int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+        int sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+        int err = dx - dy;
+        while (1) {
+            pixel(px, x0, y0, value);
+            if (x0 == x1 && y0 == y1) break;
+            int e2 = err * 2;
+            if (e2 > -dy) { err -= dy; x0 += sx; }
+            if (e2 < dx) { err += dx; y0 += sy; }
+        }
+    }
+
+private:
+    alignas(4) uint8_t memoria[4 + bytes];
+};
+
+#endif // FRAMEBUFFER_HPP
@@ -1,7 +1,34 @@
 #include "ssd1306.h"
 #include "font.h"
-#include <stdlib.h>
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+#include <string.h>
+
+// Sequência de configuração como palavras do registrador IC_DATA_CMD: o
+// byte de controle 0x00 (Co = 0, D/C = 0) abre um único fluxo de comandos e
+// a última palavra leva o bit STOP. O painel continua desligado (0xAF fica
+// fora) para que o primeiro quadro seja gravado antes de aparecer.
+static const uint16_t fluxo_config[] = {
+    0x00,
+    0xAE,                       // Display off
+    0x20, 0x00,                 // Memory mode: horizontal addressing
+    0x40,                       // Start line
+    0xA1,                       // Segment remap
+    0xA8, SSD1306_ALTURA - 1,   // Multiplex ratio
+    0xC8,                       // COM output scan direction
+    0xD3, 0x00,                 // Display offset
+    0xDA, 0x12,                 // COM pin config
+    0xD5, SSD1306_RELOGIO_PADRAO,   // Display clock divide ratio
+    0xD9, SSD1306_PRECARGA_PADRAO,  // Pre-charge period
+    0xDB, 0x30,                 // VCOM deselect level
+    0x81, 0xFF,                 // Contrast control
+    0xA4,                       // Entire display on
+    0xA6,                       // Normal display
+    0x8D, 0x14 | I2C_IC_DATA_CMD_STOP_BITS,  // Charge pump setting
+};
+
+#define FLUXO_CONFIG_PALAVRAS (sizeof(fluxo_config) / sizeof(fluxo_config[0]))
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
     ssd->width = width;
@@ -10,47 +37,147 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
     ssd->address = address;
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
-    if (ssd->ram_buffer != NULL) {
-        ssd->ram_buffer[0] = 0x40; // Co = 0, D/C = 1
+    ssd->ram_buffer = NULL;
+    if (width == SSD1306_LARGURA && height == SSD1306_ALTURA) {
+        // Framebuffer estático, já com o byte de controle (Co = 0, D/C = 1)
+        ssd->ram_buffer = ssd1306_framebuffer_reservar();
     }
     ssd->port_buffer[0] = 0x80; // Co = 1, D/C = 0
+    ssd->bytes_enviados = 0;
+    ssd->transacoes = 0;
+    ssd->canal_dma = -1;
+    ssd->fluxo_dma = -1;
+}
+
+// Mesma sequência, um comando por transação
+static void config_bloqueante(ssd1306_t *ssd) {
+    for (uint8_t i = 1; i < FLUXO_CONFIG_PALAVRAS; i++) {
+        ssd1306_command(ssd, (uint8_t)fluxo_config[i]);
+    }
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
-    ssd1306_command(ssd, 0xAE); // Display off
-    ssd1306_command(ssd, 0x20); // Memory mode
-    ssd1306_command(ssd, 0x00); // Horizontal addressing mode
-    ssd1306_command(ssd, 0x40); // Start line
-    ssd1306_command(ssd, 0xA1); // Segment remap
-    ssd1306_command(ssd, 0xA8); // Multiplex ratio
-    ssd1306_command(ssd, ssd->height - 1);
-    ssd1306_command(ssd, 0xC8); // COM output scan direction
-    ssd1306_command(ssd, 0xD3); // Display offset
-    ssd1306_command(ssd, 0x00);
-    ssd1306_command(ssd, 0xDA); // COM pin config
-    ssd1306_command(ssd, 0x12);
-    ssd1306_command(ssd, 0xD5); // Display clock divide ratio
-    ssd1306_command(ssd, 0x80);
-    ssd1306_command(ssd, 0xD9); // Pre-charge period
-    ssd1306_command(ssd, 0xF1);
-    ssd1306_command(ssd, 0xDB); // VCOM deselect level
-    ssd1306_command(ssd, 0x30);
-    ssd1306_command(ssd, 0x81); // Contrast control
-    ssd1306_command(ssd, 0xFF);
-    ssd1306_command(ssd, 0xA4); // Entire display on
-    ssd1306_command(ssd, 0xA6); // Normal display
-    ssd1306_command(ssd, 0x8D); // Charge pump setting
-    ssd1306_command(ssd, 0x14);
+    config_bloqueante(ssd);
     ssd1306_command(ssd, 0xAF); // Display on
 }
 
+// Palavras de IC_DATA_CMD por quadro: janela de endereços (com STOP),
+// byte de controle dos dados e os pixels (o último com STOP)
+#define FLUXO_QUADRO_PALAVRAS (7 + 1 + SSD1306_LARGURA * SSD1306_ALTURA / 8)
+
+#if SSD1306_MAX_ENVIOS_DMA > 0
+static uint16_t fluxos_quadro[SSD1306_MAX_ENVIOS_DMA][FLUXO_QUADRO_PALAVRAS];
+static uint8_t fluxos_usados = 0;
+#endif
+
+// Entrega um fluxo de palavras ao I2C por DMA, no ritmo do DREQ de
+// transmissão; o controlador gera um novo START após cada STOP
+static void iniciar_fluxo_dma(ssd1306_t *ssd, int canal, const uint16_t *fluxo, uint16_t palavras) {
+    // Endereço do escravo: o SDK só o define dentro de i2c_write_blocking
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    hw->enable = 0;
+    hw->tar = ssd->address;
+    hw->enable = 1;
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+
+    dma_channel_config configuracao = dma_channel_get_default_config(canal);
+    channel_config_set_transfer_data_size(&configuracao, DMA_SIZE_16);
+    channel_config_set_read_increment(&configuracao, true);
+    channel_config_set_write_increment(&configuracao, false);
+    channel_config_set_dreq(&configuracao, i2c_get_dreq(ssd->i2c_port, true));
+    dma_channel_configure(canal, &configuracao, &hw->data_cmd, fluxo, palavras, true);
+
+    ssd->canal_dma = canal;
+    ssd->bytes_enviados += palavras;
+}
+
+// Dispara a configuração por DMA e retorna logo: o canal alimenta a FIFO do
+// I2C enquanto a CPU segue com o resto da inicialização. Sem canal livre,
+// cai na configuração bloqueante. O painel fica desligado.
+bool ssd1306_config_dma(ssd1306_t *ssd) {
+    ssd1306_aguardar_dma(ssd);
+    int canal = dma_claim_unused_channel(false);
+    if (canal < 0) {
+        config_bloqueante(ssd);
+        return false;
+    }
+    iniciar_fluxo_dma(ssd, canal, fluxo_config, FLUXO_CONFIG_PALAVRAS);
+    ssd->transacoes++;
+    return true;
+}
+
+// Envia o quadro inteiro sem bloquear: os pixels são copiados para o fluxo
+// de 16 bits, então o framebuffer pode ser redesenhado logo em seguida. Sem
+// buffer ou canal livre, o envio é o bloqueante de ssd1306_send_data.
+bool ssd1306_send_data_dma(ssd1306_t *ssd) {
+    ssd1306_aguardar_dma(ssd);
+#if SSD1306_MAX_ENVIOS_DMA > 0
+    if (ssd->fluxo_dma < 0 && fluxos_usados < SSD1306_MAX_ENVIOS_DMA) {
+        ssd->fluxo_dma = fluxos_usados++;
+    }
+    int canal = ssd->fluxo_dma >= 0 ? dma_claim_unused_channel(false) : -1;
+    if (canal >= 0) {
+        uint16_t *fluxo = fluxos_quadro[ssd->fluxo_dma];
+        const uint8_t janela[] = {0x00, 0x21, 0, SSD1306_LARGURA - 1, 0x22, 0, SSD1306_ALTURA / 8 - 1};
+        for (uint8_t i = 0; i < sizeof(janela); i++) {
+            fluxo[i] = janela[i];
+        }
+        fluxo[sizeof(janela) - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+        fluxo[sizeof(janela)] = 0x40; // Co = 0, D/C = 1
+
+        const uint8_t *pixels = ssd->ram_buffer + 1;
+        uint16_t *dados = &fluxo[sizeof(janela) + 1];
+        for (uint16_t i = 0; i < SSD1306_LARGURA * SSD1306_ALTURA / 8; i++) {
+            dados[i] = pixels[i];
+        }
+        fluxo[FLUXO_QUADRO_PALAVRAS - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+
+        iniciar_fluxo_dma(ssd, canal, fluxo, FLUXO_QUADRO_PALAVRAS);
+        ssd->transacoes += 2;
+        return true;
+    }
+#endif
+    ssd1306_send_data(ssd);
+    return false;
+}
+
+bool ssd1306_dma_ocupado(const ssd1306_t *ssd) {
+    return ssd->canal_dma >= 0 && dma_channel_is_busy(ssd->canal_dma);
+}
+
+// Espera o envio por DMA sair no barramento: o canal termina ao encher a
+// FIFO, então o fim real é o STOP (ou um aborto, se o display não responder).
+// As funções bloqueantes chamam esta antes de usar o barramento.
+void ssd1306_aguardar_dma(ssd1306_t *ssd) {
+    if (ssd->canal_dma < 0) {
+        return;
+    }
+    dma_channel_wait_for_finish_blocking(ssd->canal_dma);
+
+    i2c_hw_t *hw = i2c_get_hw(ssd->i2c_port);
+    absolute_time_t limite = make_timeout_time_ms(SSD1306_DMA_LIMITE_MS);
+    while (!(hw->raw_intr_stat & (I2C_IC_RAW_INTR_STAT_STOP_DET_BITS | I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) &&
+           !time_reached(limite)) {
+        tight_loop_contents();
+    }
+    (void)hw->clr_stop_det;
+    (void)hw->clr_tx_abrt;
+
+    dma_channel_unclaim(ssd->canal_dma);
+    ssd->canal_dma = -1;
+}
+
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+    ssd1306_aguardar_dma(ssd);
     ssd->port_buffer[1] = command;
     i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->port_buffer, 2, false);
+    ssd->bytes_enviados += 2;
+    ssd->transacoes++;
 }
 
 void ssd1306_send_data(ssd1306_t *ssd) {
+    ssd1306_aguardar_dma(ssd);
     ssd1306_command(ssd, 0x21); // Column address
     ssd1306_command(ssd, 0);
     ssd1306_command(ssd, ssd->width - 1);
@@ -58,24 +185,72 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd1306_command(ssd, 0);
     ssd1306_command(ssd, ssd->pages - 1);
     i2c_write_blocking(ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false);
+    ssd->bytes_enviados += ssd->bufsize;
+    ssd->transacoes++;
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-    uint16_t index = (y / 8) * ssd->width + x + 1;
-    uint8_t pixel = y % 8;
-    if (value) {
-        ssd->ram_buffer[index] |= (1 << pixel);
-    } else {
-        ssd->ram_buffer[index] &= ~(1 << pixel);
-    }
+// Envia apenas as colunas [coluna_inicio, coluna_fim] de uma página. Os
+// comandos de endereço vão numa única transação e o byte anterior ao trecho
+// é trocado temporariamente pelo byte de controle dos dados.
+void ssd1306_send_trecho(ssd1306_t *ssd, uint8_t pagina, uint8_t coluna_inicio, uint8_t coluna_fim) {
+    ssd1306_aguardar_dma(ssd);
+    uint8_t comandos[] = {0x00, 0x21, coluna_inicio, coluna_fim, 0x22, pagina, pagina}; // Co = 0, D/C = 0
+    i2c_write_blocking(ssd->i2c_port, ssd->address, comandos, sizeof(comandos), false);
+
+    uint8_t *inicio = ssd->ram_buffer + pagina * ssd->width + coluna_inicio;
+    uint16_t tamanho = coluna_fim - coluna_inicio + 2;
+    uint8_t guardado = *inicio;
+    *inicio = 0x40;
+    i2c_write_blocking(ssd->i2c_port, ssd->address, inicio, tamanho, false);
+    *inicio = guardado;
+
+    ssd->bytes_enviados += sizeof(comandos) + tamanho;
+    ssd->transacoes += 2;
 }
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
+// Envia um retângulo de páginas x colunas com uma transação de comandos e uma
+// de dados: no modo horizontal o controlador percorre a janela página a
+// página, então os bytes são reunidos num buffer contíguo antes do envio.
+// Janelas maiores que SSD1306_JANELA_MAX_BYTES vão uma página por vez.
+void ssd1306_send_janela(ssd1306_t *ssd, uint8_t pagina_inicio, uint8_t pagina_fim,
+                         uint8_t coluna_inicio, uint8_t coluna_fim) {
+    uint8_t largura = coluna_fim - coluna_inicio + 1;
+    uint16_t tamanho = largura * (pagina_fim - pagina_inicio + 1);
+    if (tamanho > SSD1306_JANELA_MAX_BYTES) {
+        for (uint8_t pagina = pagina_inicio; pagina <= pagina_fim; pagina++) {
+            ssd1306_send_trecho(ssd, pagina, coluna_inicio, coluna_fim);
         }
+        return;
+    }
+
+    ssd1306_aguardar_dma(ssd);
+    uint8_t comandos[] = {0x00, 0x21, coluna_inicio, coluna_fim, 0x22, pagina_inicio, pagina_fim};
+    i2c_write_blocking(ssd->i2c_port, ssd->address, comandos, sizeof(comandos), false);
+
+    uint8_t dados[SSD1306_JANELA_MAX_BYTES + 1];
+    dados[0] = 0x40; // Co = 0, D/C = 1
+    for (uint8_t pagina = pagina_inicio; pagina <= pagina_fim; pagina++) {
+        memcpy(&dados[1 + (pagina - pagina_inicio) * largura],
+               ssd->ram_buffer + 1 + pagina * ssd->width + coluna_inicio, largura);
     }
+    i2c_write_blocking(ssd->i2c_port, ssd->address, dados, tamanho + 1, false);
+
+    ssd->bytes_enviados += sizeof(comandos) + tamanho + 1;
+    ssd->transacoes += 2;
+}
+
+// Frequência do oscilador/divisor (0xD5) e períodos de pré-carga (0xD9)
+void ssd1306_configurar_temporizacao(ssd1306_t *ssd, uint8_t relogio, uint8_t precarga) {
+    ssd1306_command(ssd, 0xD5);
+    ssd1306_command(ssd, relogio);
+    ssd1306_command(ssd, 0xD9);
+    ssd1306_command(ssd, precarga);
+}
+
+// Linha da RAM mostrada no topo do painel (0x40 a 0x7F): rolagem vertical
+// por hardware, sem reenviar o framebuffer
+void ssd1306_definir_linha_inicial(ssd1306_t *ssd, uint8_t linha) {
+    ssd1306_command(ssd, 0x40 | (linha & 0x3F));
 }
 
 void ssd1306_draw_small_number(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
@@ -124,6 +299,9 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y, bool use_sm
     } else if (c == '-') {
         index = 67 * 8; // Índice para '-'
         rotate = true;
+    } else if (c == '~') {
+        index = 68 * 8 + 10 * 5; // Depois dos números pequenos
+        rotate = true;
     }
 
     for (uint8_t i = 0; i < 8; ++i) {
@@ -161,46 +339,3 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y,
         str++;
     }
 }
-
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-    for (uint8_t x = left; x < left + width; ++x) {
-        ssd1306_pixel(ssd, x, top, value);
-        ssd1306_pixel(ssd, x, top + height - 1, value);
-    }
-    for (uint8_t y = top; y < top + height; ++y) {
-        ssd1306_pixel(ssd, left, y, value);
-        ssd1306_pixel(ssd, left + width - 1, y, value);
-    }
-    if (fill) {
-        for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-            for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-                ssd1306_pixel(ssd, x, y, value);
-            }
-        }
-    }
-}
-
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
-    int dx = abs(x1 - x0), dy = abs(y1 - y0);
-    int sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
-    int err = dx - dy;
-    while (1) {
-        ssd1306_pixel(ssd, x0, y0, value);
-        if (x0 == x1 && y0 == y1) break;
-        int e2 = err * 2;
-        if (e2 > -dy) { err -= dy; x0 += sx; }
-        if (e2 < dx) { err += dx; y0 += sy; }
-    }
-}
-
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-    for (uint8_t x = x0; x <= x1; ++x) {
-        ssd1306_pixel(ssd, x, y, value);
-    }
-}
-
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-    for (uint8_t y = y0; y <= y1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-    }
-}
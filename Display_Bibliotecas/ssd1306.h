@@ -5,6 +5,35 @@
 #include <stdbool.h>
 #include "hardware/i2c.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Geometria suportada pelo framebuffer estático
+#define SSD1306_LARGURA 128
+#define SSD1306_ALTURA 64
+
+// Relógio do painel (0xD5) e pré-carga (0xD9) usados por ssd1306_config
+#define SSD1306_RELOGIO_PADRAO 0x80
+#define SSD1306_PRECARGA_PADRAO 0xF1
+
+// Limite de espera pelo STOP de um envio por DMA (configuração ou quadro)
+#define SSD1306_DMA_LIMITE_MS 40
+
+// Displays que podem enviar quadros por DMA ao mesmo tempo: cada um usa um
+// buffer estático de palavras de 16 bits (2 KiB); com 0 o envio é bloqueante
+#ifndef SSD1306_MAX_ENVIOS_DMA
+#define SSD1306_MAX_ENVIOS_DMA 0
+#endif
+
+// Maior janela enviada numa só transação por ssd1306_send_janela
+#define SSD1306_JANELA_MAX_BYTES 256
+
+// Quantidade de framebuffers reservados estaticamente
+#ifndef SSD1306_MAX_FRAMEBUFFERS
+#define SSD1306_MAX_FRAMEBUFFERS 1
+#endif
+
 typedef struct {
     uint8_t width;
     uint8_t height;
@@ -14,13 +43,26 @@ typedef struct {
     uint16_t bufsize;
     uint8_t *ram_buffer;
     uint8_t port_buffer[2];
+    uint32_t bytes_enviados;     // Bytes escritos no barramento I2C (sem o endereço)
+    uint32_t transacoes;         // Transações I2C realizadas
+    int8_t canal_dma;            // Canal do envio por DMA em andamento (-1 = nenhum)
+    int8_t fluxo_dma;            // Buffer de envio de quadros reservado (-1 = nenhum)
 } ssd1306_t;
 
 // Funções existentes permanecem iguais
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
+bool ssd1306_config_dma(ssd1306_t *ssd);
+bool ssd1306_send_data_dma(ssd1306_t *ssd);
+bool ssd1306_dma_ocupado(const ssd1306_t *ssd);
+void ssd1306_aguardar_dma(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_trecho(ssd1306_t *ssd, uint8_t pagina, uint8_t coluna_inicio, uint8_t coluna_fim);
+void ssd1306_send_janela(ssd1306_t *ssd, uint8_t pagina_inicio, uint8_t pagina_fim,
+                         uint8_t coluna_inicio, uint8_t coluna_fim);
+void ssd1306_configurar_temporizacao(ssd1306_t *ssd, uint8_t relogio, uint8_t precarga);
+void ssd1306_definir_linha_inicial(ssd1306_t *ssd, uint8_t linha);
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
 void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
@@ -33,4 +75,11 @@ void ssd1306_draw_small_number(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y, bool use_small_numbers);
 void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y, bool use_small_numbers);
 
+// Reserva um framebuffer estático (ssd1306_framebuffer.cpp); NULL se acabaram
+uint8_t *ssd1306_framebuffer_reservar(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // SSD1306_H
@@ -0,0 +1,44 @@
+// Ponte C para o Framebuffer<W, H>: as primitivas ssd1306_* continuam com a
+// mesma assinatura, mas a geometria é constante e a memória é estática.
+#include "ssd1306.h"
+#include "framebuffer.hpp"
+
+using FramebufferTela = Framebuffer<SSD1306_LARGURA, SSD1306_ALTURA>;
+
+static FramebufferTela framebuffers[SSD1306_MAX_FRAMEBUFFERS];
+static uint8_t framebuffers_usados = 0;
+
+extern "C" {
+
+uint8_t *ssd1306_framebuffer_reservar(void) {
+    if (framebuffers_usados >= SSD1306_MAX_FRAMEBUFFERS) {
+        return nullptr;
+    }
+    return framebuffers[framebuffers_usados++].ram_buffer();
+}
+
+void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+    FramebufferTela::pixel(ssd->ram_buffer + 1, x, y, value);
+}
+
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+    FramebufferTela::fill(ssd->ram_buffer + 1, value);
+}
+
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+    FramebufferTela::rect(ssd->ram_buffer + 1, top, left, width, height, value, fill);
+}
+
+void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
+    FramebufferTela::line(ssd->ram_buffer + 1, x0, y0, x1, y1, value);
+}
+
+void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
+    FramebufferTela::hline(ssd->ram_buffer + 1, x0, x1, y, value);
+}
+
+void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
+    FramebufferTela::vline(ssd->ram_buffer + 1, x, y0, y1, value);
+}
+
+} // extern "C"
@@ -0,0 +1,157 @@
+#include "texto.h"
+#include <math.h>
+
+static const uint32_t potencias_10[] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+// Destino dos caracteres: buffer do chamador ou glifos no display
+typedef struct {
+    char *atual;
+    const char *fim;
+    ssd1306_t *ssd;
+    uint8_t x;
+    uint8_t y;
+    bool pequenos;
+} SaidaTexto;
+
+static void emitir(SaidaTexto *saida, char c) {
+    if (saida->ssd != NULL) {
+        // O que não cabe na linha é descartado
+        uint8_t largura = (saida->pequenos && c >= '0' && c <= '9') ? 5 : 8;
+        if (saida->x + largura <= saida->ssd->width) {
+            ssd1306_draw_char(saida->ssd, c, saida->x, saida->y, saida->pequenos);
+            saida->x += largura;
+        }
+    } else if (saida->atual + 1 < saida->fim) {
+        *saida->atual++ = c;
+    }
+}
+
+// Quantidade de dígitos decimais de n (pelo menos 1)
+static uint8_t contar_digitos(uint32_t n) {
+    uint8_t digitos = 1;
+    while (digitos < 10 && n >= potencias_10[digitos]) {
+        digitos++;
+    }
+    return digitos;
+}
+
+// Emite n com exatamente 'digitos' dígitos, do mais significativo ao menos
+static void emitir_digitos(SaidaTexto *saida, uint32_t n, uint8_t digitos) {
+    while (digitos-- > 0) {
+        uint32_t potencia = potencias_10[digitos];
+        uint32_t digito = n / potencia;
+        emitir(saida, (char)('0' + digito));
+        n -= digito * potencia;
+    }
+}
+
+static void emitir_preenchimento(SaidaTexto *saida, uint8_t comprimento, uint8_t largura) {
+    for (; comprimento < largura; comprimento++) {
+        emitir(saida, ' ');
+    }
+}
+
+static void emitir_numero(SaidaTexto *saida, float valor, uint8_t casas, uint8_t largura) {
+    if (casas > TEXTO_CASAS_MAXIMO) {
+        casas = TEXTO_CASAS_MAXIMO;
+    }
+    bool negativo = signbit(valor);
+    float modulo = fabsf(valor);
+
+    if (!(modulo < 4e18f)) {
+        const char *texto = isnan(valor) ? "nan" : (negativo ? "-inf" : "inf");
+        uint8_t comprimento = isnan(valor) || !negativo ? 3 : 4;
+        emitir_preenchimento(saida, comprimento, largura);
+        for (; *texto; texto++) {
+            emitir(saida, *texto);
+        }
+        return;
+    }
+
+    // Parte inteira truncada (exata em float) e fração arredondada nas casas
+    // pedidas; o vai-um da fração sobe para a parte inteira. Acima de 2^32 a
+    // parte inteira é dividida em alto * 10^9 + baixo.
+    uint32_t alto = 0;
+    uint32_t baixo;
+    float inteira = floorf(modulo);
+    if (inteira >= 4294967296.0f) {
+        alto = (uint32_t)(inteira / 1e9f);
+        float resto = inteira - (float)alto * 1e9f;
+        baixo = resto > 0 ? (uint32_t)resto : 0;
+        if (baixo >= 1000000000u) baixo = 999999999u;
+    } else {
+        baixo = (uint32_t)inteira;
+    }
+    uint32_t escala = potencias_10[casas];
+    uint32_t fracao = (uint32_t)((modulo - inteira) * (float)escala + 0.5f);
+    if (fracao >= escala) {
+        fracao -= escala;
+        if (++baixo == 1000000000u && alto > 0) {
+            alto++;
+            baixo = 0;
+        }
+    }
+
+    // Sem sinal quando tudo arredonda para zero ("0.00" em vez de "-0.00")
+    if (alto == 0 && baixo == 0 && fracao == 0) {
+        negativo = false;
+    }
+
+    uint8_t digitos_alto = alto > 0 ? contar_digitos(alto) : 0;
+    uint8_t digitos_baixo = alto > 0 ? 9 : contar_digitos(baixo);
+    uint8_t comprimento = negativo + digitos_alto + digitos_baixo + (casas > 0 ? 1 + casas : 0);
+    emitir_preenchimento(saida, comprimento, largura);
+
+    if (negativo) {
+        emitir(saida, '-');
+    }
+    if (alto > 0) {
+        emitir_digitos(saida, alto, digitos_alto);
+    }
+    emitir_digitos(saida, baixo, digitos_baixo);
+    if (casas > 0) {
+        emitir(saida, '.');
+        emitir_digitos(saida, fracao, casas);
+    }
+}
+
+char *texto_anexar(char *destino, const char *fim, const char *texto) {
+    if (destino >= fim) {
+        return destino;
+    }
+    SaidaTexto saida = {.atual = destino, .fim = fim};
+    for (; *texto; texto++) {
+        emitir(&saida, *texto);
+    }
+    *saida.atual = '\0';
+    return saida.atual;
+}
+
+char *texto_numero(char *destino, const char *fim, float valor, uint8_t casas, uint8_t largura) {
+    if (destino >= fim) {
+        return destino;
+    }
+    SaidaTexto saida = {.atual = destino, .fim = fim};
+    emitir_numero(&saida, valor, casas, largura);
+    *saida.atual = '\0';
+    return saida.atual;
+}
+
+const char *texto_decimal(float valor, uint8_t casas) {
+    // Sinal, 19 dígitos, ponto, TEXTO_CASAS_MAXIMO casas e o '\0'
+    static char buffers[TEXTO_DECIMAIS_ROTATIVOS][28];
+    static uint8_t proximo = 0;
+    char *buffer = buffers[proximo];
+    proximo = (proximo + 1) % TEXTO_DECIMAIS_ROTATIVOS;
+    texto_numero(buffer, buffer + sizeof(buffers[0]), valor, casas, 0);
+    return buffer;
+}
+
+uint8_t texto_desenhar_numero(ssd1306_t *ssd, float valor, uint8_t casas, uint8_t largura,
+                              uint8_t x, uint8_t y, bool use_small_numbers) {
+    SaidaTexto saida = {.ssd = ssd, .x = x, .y = y, .pequenos = use_small_numbers};
+    emitir_numero(&saida, valor, casas, largura);
+    return saida.x;
+}
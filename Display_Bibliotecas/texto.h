@@ -0,0 +1,32 @@
+#ifndef TEXTO_H
+#define TEXTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ssd1306.h"
+
+// Números em ponto fixo sem printf e sem alocação: o valor é arredondado
+// para 'casas' decimais (até TEXTO_CASAS_MAXIMO, meio para longe do zero) e,
+// com largura > 0, alinhado à direita com espaços. Um valor que arredonda
+// para zero sai sem sinal; módulos a partir de 4e18, infinito e NaN saem
+// como "inf", "-inf" e "nan".
+#define TEXTO_CASAS_MAXIMO 6
+
+// Textos encadeados num buffer do chamador: cada função escreve a partir de
+// 'destino' sem passar de 'fim' (um após o último byte), termina com '\0' e
+// devolve a posição do '\0' para a próxima parte
+char *texto_anexar(char *destino, const char *fim, const char *texto);
+char *texto_numero(char *destino, const char *fim, float valor, uint8_t casas, uint8_t largura);
+
+// Desenha o número direto com os glifos do display, sem montar o texto;
+// devolve a coluna seguinte ao último caractere
+uint8_t texto_desenhar_numero(ssd1306_t *ssd, float valor, uint8_t casas, uint8_t largura,
+                              uint8_t x, uint8_t y, bool use_small_numbers);
+
+// Número num buffer interno rotativo, para passar direto a um "%s" do printf
+// sem ligar o printf de ponto flutuante; os TEXTO_DECIMAIS_ROTATIVOS
+// resultados mais recentes continuam válidos. Só para o laço principal.
+#define TEXTO_DECIMAIS_ROTATIVOS 10
+const char *texto_decimal(float valor, uint8_t casas);
+
+#endif // TEXTO_H
@@ -0,0 +1,101 @@
+#include "agendador.h"
+#include "hardware/adc.h"
+#include "hardware/sync.h"
+#include "rastro.h"
+#include "osciloscopio.h"
+
+#define INTERVALO_JOYSTICK_MS 20   // Amostragem do joystick para o evento de limiar
+
+static volatile uint32_t eventos_pendentes = 0;
+static volatile uint32_t instante_primeiro_evento = 0;  // time_us_32 do primeiro evento pendente
+static uint32_t instante_eventos_entregues = 0;         // Idem, para o último lote retornado
+
+static repeating_timer_t temporizador_joystick;
+static uint canal_joystick;
+static int16_t limiar_joystick;
+static bool joystick_fora_do_centro = false;
+
+void agendador_sinalizar(uint32_t eventos) {
+    uint32_t estado = save_and_disable_interrupts();
+    if (eventos_pendentes == 0) {
+        instante_primeiro_evento = time_us_32();
+    }
+    eventos_pendentes |= eventos;
+    restore_interrupts(estado);
+}
+
+// O ADC não tem comparador: o limiar é verificado por amostragem periódica.
+// Com o osciloscópio capturando, a leitura vem da própria captura.
+static bool amostrar_joystick(repeating_timer_t *temporizador) {
+    uint16_t leitura;
+    if (!osciloscopio_ler_canal(canal_joystick, &leitura)) {
+        adc_select_input(canal_joystick);
+        leitura = adc_read();
+    }
+    int16_t diferenca = (int16_t)leitura - 2048;
+    bool fora = diferenca > limiar_joystick || diferenca < -limiar_joystick;
+
+    if (fora || joystick_fora_do_centro) {
+        // Só as amostras que acordam o laço entram no rastro
+        rastro_registrar(RASTRO_ADC, canal_joystick, leitura);
+        agendador_sinalizar(EVENTO_JOYSTICK);
+    }
+    joystick_fora_do_centro = fora;
+    return true;
+}
+
+static void caracteres_disponiveis(void *parametro) {
+    agendador_sinalizar(EVENTO_USB);
+}
+
+static int64_t prazo_vencido(alarm_id_t id, void *dados) {
+    agendador_sinalizar(EVENTO_TEMPORIZADOR);
+    return 0;
+}
+
+void agendador_iniciar(uint adc_canal_joystick, int16_t zona_morta) {
+    canal_joystick = adc_canal_joystick;
+    limiar_joystick = zona_morta;
+    add_repeating_timer_ms(INTERVALO_JOYSTICK_MS, amostrar_joystick, NULL, &temporizador_joystick);
+    stdio_set_chars_available_callback(caracteres_disponiveis, NULL);
+}
+
+// Dorme em WFI até chegar um evento ou vencer o prazo (0 = não dormir).
+// Retorna e limpa os eventos pendentes.
+uint32_t agendador_aguardar(int64_t prazo_us) {
+    alarm_id_t alarme = 0;
+
+    if (prazo_us > 0) {
+        alarme = add_alarm_in_us(prazo_us, prazo_vencido, NULL, true);
+    }
+
+    if (prazo_us != 0) {
+        while (true) {
+            // Com as interrupções mascaradas não há corrida entre o teste e o WFI:
+            // uma interrupção pendente acorda o núcleo mesmo assim
+            uint32_t estado = save_and_disable_interrupts();
+            if (eventos_pendentes != 0) {
+                restore_interrupts(estado);
+                break;
+            }
+            __wfi();
+            restore_interrupts(estado);
+        }
+    }
+
+    if (alarme > 0) {
+        cancel_alarm(alarme);
+    }
+
+    uint32_t estado = save_and_disable_interrupts();
+    uint32_t eventos = eventos_pendentes;
+    eventos_pendentes = 0;
+    instante_eventos_entregues = instante_primeiro_evento;
+    restore_interrupts(estado);
+    return eventos;
+}
+
+// Instante (time_us_32) em que chegou o primeiro evento do último lote entregue
+uint32_t agendador_instante_eventos(void) {
+    return instante_eventos_entregues;
+}
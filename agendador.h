@@ -0,0 +1,25 @@
+#ifndef AGENDADOR_H
+#define AGENDADOR_H
+
+#include "pico/stdlib.h"
+
+// Eventos que acordam o laço principal
+typedef enum {
+    EVENTO_BOTAO = 1u << 0,         // Borda em um dos botões
+    EVENTO_JOYSTICK = 1u << 1,      // Joystick fora da zona morta ou de volta ao centro
+    EVENTO_USB = 1u << 2,           // Caracteres recebidos pela stdio
+    EVENTO_TEMPORIZADOR = 1u << 3,  // Prazo pedido em agendador_aguardar
+    EVENTO_OSCILOSCOPIO = 1u << 4   // Quadro novo da captura do ADC
+} Evento;
+
+#define EVENTOS_ENTRADA (EVENTO_BOTAO | EVENTO_JOYSTICK | EVENTO_USB)
+
+// Prazo para agendador_aguardar sem limite de tempo
+#define AGENDADOR_SEM_PRAZO (-1)
+
+void agendador_iniciar(uint adc_canal_joystick, int16_t zona_morta);
+void agendador_sinalizar(uint32_t eventos);
+uint32_t agendador_aguardar(int64_t prazo_us);
+uint32_t agendador_instante_eventos(void);
+
+#endif // AGENDADOR_H
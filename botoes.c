@@ -0,0 +1,142 @@
+#include "botoes.h"
+#include "agendador.h"
+#include "rastro.h"
+#include "hardware/gpio.h"
+
+#define MAX_BOTOES 4
+#define TAMANHO_FILA_EVENTOS 16
+
+// Estado de cada botão; alterado apenas pelas interrupções de GPIO e do timer
+typedef struct {
+    uint pino;
+    bool pressionado;          // Nível estável após o debounce
+    bool longo;                // Já gerou BOTAO_LONGO nesta pressão
+    bool ignorar_ate_soltar;   // Pressão usada para acordar o sistema
+    uint16_t repeticoes;
+    alarm_id_t alarme_debounce;
+    alarm_id_t alarme_pressao;
+} Botao;
+
+static Botao botoes[MAX_BOTOES];
+static uint8_t total_botoes = 0;
+
+static volatile EventoBotao fila[TAMANHO_FILA_EVENTOS];
+static volatile uint8_t inicio_fila = 0;
+static volatile uint8_t fim_fila = 0;
+
+static void emitir(Botao *botao, TipoEventoBotao tipo) {
+    if (botao->ignorar_ate_soltar) {
+        return;
+    }
+    uint8_t proximo = (fim_fila + 1) % TAMANHO_FILA_EVENTOS;
+    if (proximo == inicio_fila) {
+        return;  // Fila cheia: o evento é perdido
+    }
+    fila[fim_fila].pino = botao->pino;
+    fila[fim_fila].tipo = tipo;
+    fila[fim_fila].repeticoes = botao->repeticoes;
+    fim_fila = proximo;
+    agendador_sinalizar(EVENTO_BOTAO);
+}
+
+// Pressão longa e, depois dela, repetições em intervalo fixo
+static int64_t tempo_pressionado(alarm_id_t id, void *dados) {
+    Botao *botao = dados;
+
+    if (!botao->longo) {
+        botao->longo = true;
+        emitir(botao, BOTAO_LONGO);
+    } else {
+        botao->repeticoes++;
+        emitir(botao, BOTAO_REPETIR);
+    }
+    return INTERVALO_REPETICAO_MS * 1000;
+}
+
+// Fim da janela de debounce: o nível atual é considerado estável
+static int64_t fim_debounce(alarm_id_t id, void *dados) {
+    Botao *botao = dados;
+    botao->alarme_debounce = 0;
+
+    bool pressionado = !gpio_get(botao->pino);
+    if (pressionado == botao->pressionado) {
+        return 0;
+    }
+    botao->pressionado = pressionado;
+
+    if (pressionado) {
+        botao->longo = false;
+        botao->repeticoes = 0;
+        emitir(botao, BOTAO_PRESSIONAR);
+        botao->alarme_pressao = add_alarm_in_ms(TEMPO_PRESSAO_LONGA_MS, tempo_pressionado, botao, true);
+    } else {
+        if (botao->alarme_pressao > 0) {
+            cancel_alarm(botao->alarme_pressao);
+            botao->alarme_pressao = 0;
+        }
+        emitir(botao, BOTAO_SOLTAR);
+        if (!botao->longo) {
+            emitir(botao, BOTAO_CURTO);
+        }
+        botao->ignorar_ate_soltar = false;
+    }
+    return 0;
+}
+
+// Cada borda reinicia a janela de debounce apenas do próprio botão
+static void tratar_interrupcao_gpio(uint gpio, uint32_t eventos) {
+    rastro_registrar(RASTRO_GPIO_ENTRADA, gpio, eventos);
+    for (uint8_t i = 0; i < total_botoes; i++) {
+        if (botoes[i].pino == gpio) {
+            if (botoes[i].alarme_debounce > 0) {
+                cancel_alarm(botoes[i].alarme_debounce);
+            }
+            botoes[i].alarme_debounce = add_alarm_in_ms(TEMPO_DEBOUNCE_MS, fim_debounce, &botoes[i], true);
+            break;
+        }
+    }
+    rastro_registrar(RASTRO_GPIO_SAIDA, gpio, 0);
+}
+
+void botoes_iniciar(const uint *pinos, uint8_t quantidade) {
+    for (uint8_t i = 0; i < quantidade && i < MAX_BOTOES; i++) {
+        botoes[i].pino = pinos[i];
+        gpio_init(pinos[i]);
+        gpio_set_dir(pinos[i], GPIO_IN);
+        gpio_pull_up(pinos[i]);
+        gpio_set_irq_enabled_with_callback(pinos[i], GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true,
+                                           &tratar_interrupcao_gpio);
+        total_botoes++;
+    }
+}
+
+bool botoes_proximo_evento(EventoBotao *evento) {
+    if (inicio_fila == fim_fila) {
+        return false;
+    }
+    evento->pino = fila[inicio_fila].pino;
+    evento->tipo = fila[inicio_fila].tipo;
+    evento->repeticoes = fila[inicio_fila].repeticoes;
+    inicio_fila = (inicio_fila + 1) % TAMANHO_FILA_EVENTOS;
+    return true;
+}
+
+// Descarta a fila e o restante das pressões em andamento
+void botoes_descartar_eventos(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    inicio_fila = fim_fila;
+    for (uint8_t i = 0; i < total_botoes; i++) {
+        if (botoes[i].pressionado) {
+            botoes[i].ignorar_ate_soltar = true;
+        }
+    }
+    restore_interrupts(estado);
+}
+
+// Passo de ajuste de parâmetros: acelera enquanto o botão é mantido
+float botoes_passo_acelerado(uint16_t repeticoes) {
+    if (repeticoes < 5) return 0.5f;
+    if (repeticoes < 10) return 1.0f;
+    if (repeticoes < 20) return 5.0f;
+    return 10.0f;
+}
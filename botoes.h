@@ -0,0 +1,30 @@
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include "pico/stdlib.h"
+
+// Eventos gerados pela máquina de estados de cada botão
+typedef enum {
+    BOTAO_PRESSIONAR,   // Borda de descida confirmada pelo debounce
+    BOTAO_SOLTAR,       // Borda de subida confirmada pelo debounce
+    BOTAO_CURTO,        // Soltou antes de virar pressão longa
+    BOTAO_LONGO,        // Mantido por TEMPO_PRESSAO_LONGA_MS
+    BOTAO_REPETIR       // Repetição enquanto continua pressionado
+} TipoEventoBotao;
+
+typedef struct {
+    uint pino;
+    TipoEventoBotao tipo;
+    uint16_t repeticoes;  // Repetições desde a pressão longa (para acelerar passos)
+} EventoBotao;
+
+#define TEMPO_DEBOUNCE_MS 20
+#define TEMPO_PRESSAO_LONGA_MS 500
+#define INTERVALO_REPETICAO_MS 100
+
+void botoes_iniciar(const uint *pinos, uint8_t quantidade);
+bool botoes_proximo_evento(EventoBotao *evento);
+void botoes_descartar_eventos(void);
+float botoes_passo_acelerado(uint16_t repeticoes);
+
+#endif // BOTOES_H
@@ -0,0 +1,204 @@
+#include "cache_amostras.h"
+#include <math.h>
+#include <string.h>
+
+#define PALAVRAS_VALIDOS ((CACHE_PONTOS + 31) / 32)
+#define INDICE_MAXIMO 1000000.0f  // Acima disso x = k * 2^n deixa de ser exato em float
+
+typedef struct {
+    bool usado;
+    int32_t k_inicio;                    // Índice do primeiro ponto da janela
+    uint32_t validos[PALAVRAS_VALIDOS];  // Um bit por ponto já avaliado
+    float y[CACHE_PONTOS];
+} NivelCache;
+
+static NivelCache niveis[CACHE_NIVEIS];
+static bool habilitado = true;
+static bool chave_valida = false;
+static uint8_t chave_funcao;
+static float chave_parametros[4];
+static EstatisticasCache estatisticas;
+
+// Contexto da avaliação em andamento
+static const float *parametros_atuais;
+static FuncaoAvaliacao avaliar_atual;
+
+static inline bool ponto_valido(const NivelCache *nivel, uint32_t i) {
+    return nivel->validos[i / 32] & (1u << (i % 32));
+}
+
+static inline void marcar_ponto(NivelCache *nivel, uint32_t i, bool valido) {
+    if (valido) {
+        nivel->validos[i / 32] |= 1u << (i % 32);
+    } else {
+        nivel->validos[i / 32] &= ~(1u << (i % 32));
+    }
+}
+
+void cache_amostras_invalidar(void) {
+    for (uint8_t n = 0; n < CACHE_NIVEIS; n++) {
+        niveis[n].usado = false;
+    }
+    chave_valida = false;
+}
+
+// Descarta tudo se a função ou algum parâmetro mudou
+static void verificar_chave(uint8_t funcao, const float *parametros) {
+    if (chave_valida && chave_funcao == funcao && memcmp(chave_parametros, parametros, sizeof(chave_parametros)) == 0) {
+        return;
+    }
+    if (chave_valida) {
+        estatisticas.descartes++;
+    }
+    cache_amostras_invalidar();
+    chave_funcao = funcao;
+    memcpy(chave_parametros, parametros, sizeof(chave_parametros));
+    chave_valida = true;
+}
+
+// Move a janela do nível para começar em k_inicio, mantendo os pontos em comum
+static void posicionar_janela(NivelCache *nivel, int32_t k_inicio) {
+    if (!nivel->usado) {
+        memset(nivel->validos, 0, sizeof(nivel->validos));
+        nivel->k_inicio = k_inicio;
+        nivel->usado = true;
+        return;
+    }
+
+    int32_t deslocamento = k_inicio - nivel->k_inicio;
+    if (deslocamento == 0) {
+        return;
+    }
+    if (deslocamento >= CACHE_PONTOS || deslocamento <= -CACHE_PONTOS) {
+        memset(nivel->validos, 0, sizeof(nivel->validos));
+    } else if (deslocamento > 0) {
+        for (int32_t i = 0; i < CACHE_PONTOS; i++) {
+            int32_t origem = i + deslocamento;
+            bool valido = origem < CACHE_PONTOS && ponto_valido(nivel, origem);
+            if (valido) {
+                nivel->y[i] = nivel->y[origem];
+            }
+            marcar_ponto(nivel, i, valido);
+        }
+    } else {
+        for (int32_t i = CACHE_PONTOS - 1; i >= 0; i--) {
+            int32_t origem = i + deslocamento;
+            bool valido = origem >= 0 && ponto_valido(nivel, origem);
+            if (valido) {
+                nivel->y[i] = nivel->y[origem];
+            }
+            marcar_ponto(nivel, i, valido);
+        }
+    }
+    nivel->k_inicio = k_inicio;
+}
+
+// Procura o ponto k do nível n, se a janela do nível o contiver
+static bool consultar(int8_t n, int32_t k, float *y) {
+    if (n < 0 || n >= CACHE_NIVEIS || !niveis[n].usado) {
+        return false;
+    }
+    NivelCache *nivel = &niveis[n];
+    int32_t i = k - nivel->k_inicio;
+    if (i < 0 || i >= CACHE_PONTOS || !ponto_valido(nivel, i)) {
+        return false;
+    }
+    *y = nivel->y[i];
+    return true;
+}
+
+// Valor no ponto k do nível n: do próprio nível, de um nível vizinho ou avaliado
+static float obter_ponto(int8_t n, int32_t k, float espacamento) {
+    NivelCache *nivel = &niveis[n];
+    uint32_t i = (uint32_t)(k - nivel->k_inicio);
+    if (ponto_valido(nivel, i)) {
+        estatisticas.reaproveitados++;
+        return nivel->y[i];
+    }
+
+    float y;
+    if (consultar(n - 1, 2 * k, &y) || ((k & 1) == 0 && consultar(n + 1, k / 2, &y))) {
+        estatisticas.reaproveitados++;
+    } else {
+        y = avaliar_atual(parametros_atuais, k * espacamento);
+        estatisticas.avaliados++;
+    }
+    nivel->y[i] = y;
+    marcar_ponto(nivel, i, true);
+    return y;
+}
+
+void cache_amostras_preencher(uint8_t funcao, const float *parametros, FuncaoAvaliacao avaliar,
+                              float x_inicial, float passo_x, float tolerancia_y, float *saida, uint16_t n) {
+    // Nível com espaçamento 2^nivel <= passo_x < 2^(nivel + 1)
+    int expoente;
+    frexpf(passo_x, &expoente);
+    int nivel = expoente - 1 - CACHE_NIVEL_MINIMO;
+    float espacamento = ldexpf(1.0f, expoente - 1);
+    float x_final = x_inicial + (n - 1) * passo_x;
+
+    if (!habilitado || n == 0 || nivel < 0 || nivel >= CACHE_NIVEIS ||
+        fabsf(x_inicial) / espacamento > INDICE_MAXIMO || fabsf(x_final) / espacamento > INDICE_MAXIMO) {
+        for (uint16_t i = 0; i < n; i++) {
+            saida[i] = avaliar(parametros, x_inicial + i * passo_x);
+        }
+        estatisticas.diretas += n;
+        return;
+    }
+
+    verificar_chave(funcao, parametros);
+    parametros_atuais = parametros;
+    avaliar_atual = avaliar;
+
+    // A janela é reposicionada só quando a vista sai dela, centrando a folga;
+    // cada intervalo usa também um ponto vizinho de cada lado
+    NivelCache *atual = &niveis[nivel];
+    int32_t k_primeiro = (int32_t)floorf(x_inicial / espacamento) - 1;
+    int32_t k_ultimo = (int32_t)floorf(x_final / espacamento) + 2;
+    if (!atual->usado || k_primeiro < atual->k_inicio || k_ultimo >= atual->k_inicio + CACHE_PONTOS) {
+        int32_t folga = CACHE_PONTOS - (k_ultimo - k_primeiro + 1);
+        posicionar_janela(atual, k_primeiro - folga / 2);
+    }
+
+    // O erro da interpolação linear é cerca de |f''| h² / 8; a segunda diferença
+    // dos pontos vizinhos o estima e, acima da tolerância, a coluna é avaliada
+    float limite = 8 * tolerancia_y;
+    for (uint16_t i = 0; i < n; i++) {
+        float x = x_inicial + i * passo_x;
+        float u = x / espacamento;
+        int32_t k = (int32_t)floorf(u);
+        float t = u - k;
+        float y0 = obter_ponto(nivel, k, espacamento);
+        if (t <= 0) {
+            saida[i] = y0;
+            continue;
+        }
+
+        float y1 = obter_ponto(nivel, k + 1, espacamento);
+        float anterior = obter_ponto(nivel, k - 1, espacamento);
+        float seguinte = obter_ponto(nivel, k + 2, espacamento);
+        if (fabsf(anterior - 2 * y0 + y1) > limite || fabsf(y0 - 2 * y1 + seguinte) > limite) {
+            saida[i] = avaliar(parametros, x);
+            estatisticas.diretas++;
+        } else {
+            saida[i] = y0 + t * (y1 - y0);
+        }
+    }
+}
+
+void cache_amostras_habilitar(bool habilitar) {
+    habilitado = habilitar;
+    cache_amostras_invalidar();
+}
+
+bool cache_amostras_habilitado(void) {
+    return habilitado;
+}
+
+const EstatisticasCache *cache_amostras_estatisticas(void) {
+    return &estatisticas;
+}
+
+void cache_amostras_zerar_estatisticas(void) {
+    memset(&estatisticas, 0, sizeof(estatisticas));
+}
@@ -0,0 +1,35 @@
+#ifndef CACHE_AMOSTRAS_H
+#define CACHE_AMOSTRAS_H
+
+#include "pico/stdlib.h"
+
+// Cache de amostras da curva em vários níveis de resolução, como mipmaps: o
+// nível n guarda pontos em x = k * 2^n. Uma vista usa o nível cujo espaçamento
+// não passa do passo entre colunas e interpola entre os dois pontos vizinhos,
+// avaliando só os que faltam. Pontos de um nível também são procurados nos
+// níveis vizinhos (o ponto k do nível n é o ponto 2k do nível n - 1). O cache
+// é chaveado pela função e pelos parâmetros e descartado quando eles mudam.
+#define CACHE_NIVEL_MINIMO -5    // Espaçamento de 1/32 (zoom até 32x)
+#define CACHE_NIVEIS 10          // Até espaçamento 16 (zoom até 1/16x)
+#define CACHE_PONTOS 260         // Pontos por nível: até 2 por coluna + vizinhos
+
+typedef float (*FuncaoAvaliacao)(const float *parametros, float x);
+
+typedef struct {
+    uint32_t avaliados;          // Pontos calculados com a função
+    uint32_t reaproveitados;     // Pontos lidos do cache
+    uint32_t descartes;          // Invalidações por mudança de função ou parâmetros
+    uint32_t diretas;            // Colunas avaliadas sem o cache (fora dos níveis ou curvatura alta)
+} EstatisticasCache;
+
+// Preenche n colunas com y(x_inicial + i * passo_x). Onde a curvatura faria a
+// interpolação errar mais que tolerancia_y, a coluna é avaliada diretamente.
+void cache_amostras_preencher(uint8_t funcao, const float *parametros, FuncaoAvaliacao avaliar,
+                              float x_inicial, float passo_x, float tolerancia_y, float *saida, uint16_t n);
+void cache_amostras_invalidar(void);
+void cache_amostras_habilitar(bool habilitar);
+bool cache_amostras_habilitado(void);
+const EstatisticasCache *cache_amostras_estatisticas(void);
+void cache_amostras_zerar_estatisticas(void);
+
+#endif // CACHE_AMOSTRAS_H
@@ -0,0 +1,839 @@
+#include "comandos_usb.h"
+#include <stdio.h>
+#include <string.h>
+#include "energia.h"
+#include "transmissao_usb.h"
+#include "escala_cinza.h"
+#include "perfilador.h"
+#include "rastro.h"
+#include "sessao.h"
+#include "cache_amostras.h"
+#include "osciloscopio.h"
+#include "curvas.h"
+#include "partida.h"
+#include "led_rgb.h"
+#include "memoria.h"
+#include "Display_Bibliotecas/texto.h"
+
+#define COMANDO_TAMANHO_MAXIMO 96
+#define COMANDO_MAX_ARGUMENTOS 10
+#define RENDER_MAX_REPETICOES 1000
+
+typedef void (*ExecutarComando)(Sistema *sistema, char **argumentos, uint8_t quantidade);
+
+typedef struct {
+    const char *nome;
+    uint8_t minimo_argumentos;
+    ExecutarComando executar;
+    const char *ajuda;
+} Comando;
+
+// Linha em montagem; os argumentos apontam para dentro dela
+static char linha[COMANDO_TAMANHO_MAXIMO];
+static uint8_t tamanho_linha = 0;
+static bool linha_longa = false;
+
+// Converte texto em float sem strtof (que usa o heap na newlib)
+static bool analisar_numero(const char *texto, float *valor) {
+    bool negativo = false;
+    bool tem_digitos = false;
+    int32_t inteiro = 0;
+    float fracao = 0.0f;
+    float escala = 0.1f;
+
+    if (*texto == '-' || *texto == '+') {
+        negativo = (*texto == '-');
+        texto++;
+    }
+    while (*texto >= '0' && *texto <= '9') {
+        if (inteiro > 1000000) return false;
+        inteiro = inteiro * 10 + (*texto - '0');
+        tem_digitos = true;
+        texto++;
+    }
+    if (*texto == '.') {
+        texto++;
+        while (*texto >= '0' && *texto <= '9') {
+            fracao += (*texto - '0') * escala;
+            escala *= 0.1f;
+            tem_digitos = true;
+            texto++;
+        }
+    }
+    if (*texto != '\0' || !tem_digitos) {
+        return false;
+    }
+
+    *valor = negativo ? -(inteiro + fracao) : (inteiro + fracao);
+    return true;
+}
+
+static bool analisar_inteiro(const char *texto, int32_t minimo, int32_t maximo, int32_t *valor) {
+    float numero;
+    if (!analisar_numero(texto, &numero) || numero != (int32_t)numero) {
+        return false;
+    }
+    if (numero < minimo || numero > maximo) {
+        return false;
+    }
+    *valor = (int32_t)numero;
+    return true;
+}
+
+// Inteiro sem sinal exato (o float de analisar_numero perde precisão acima de 2^24)
+static bool analisar_natural(const char *texto, uint32_t *valor) {
+    uint32_t resultado = 0;
+    if (*texto == '\0') {
+        return false;
+    }
+    while (*texto >= '0' && *texto <= '9') {
+        uint32_t digito = *texto - '0';
+        if (resultado > (UINT32_MAX - digito) / 10) return false;
+        resultado = resultado * 10 + digito;
+        texto++;
+    }
+    if (*texto != '\0') {
+        return false;
+    }
+    *valor = resultado;
+    return true;
+}
+
+// Aceita A-D (maiúsculas ou minúsculas) ou 0-3
+static bool analisar_indice_parametro(const char *texto, uint8_t *indice) {
+    if (texto[0] != '\0' && texto[1] == '\0') {
+        if (texto[0] >= 'A' && texto[0] <= 'D') { *indice = texto[0] - 'A'; return true; }
+        if (texto[0] >= 'a' && texto[0] <= 'd') { *indice = texto[0] - 'a'; return true; }
+        if (texto[0] >= '0' && texto[0] <= '3') { *indice = texto[0] - '0'; return true; }
+    }
+    return false;
+}
+
+static void comando_funcao(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t funcao;
+    if (!analisar_inteiro(argumentos[0], 0, TOTAL_FUNCOES - 1, &funcao)) {
+        printf("erro funcao invalida\n");
+        return;
+    }
+    parar_animacao(sistema);
+    sistema->funcao_selecionada = (TipoFuncao)funcao;
+    atualizar_cores_rgb();
+    printf("ok funcao %d\n", (int)funcao);
+}
+
+static void comando_param(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    uint8_t indice;
+    float valor;
+    if (!analisar_indice_parametro(argumentos[0], &indice) || !analisar_numero(argumentos[1], &valor)) {
+        printf("erro uso: param <A-D> <valor>\n");
+        return;
+    }
+    parar_animacao(sistema);
+    sistema->parametros[indice] = valor;
+    printf("ok param %c %s\n", 'A' + indice, texto_decimal(valor, 3));
+}
+
+static void comando_params(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    float valores[4];
+    for (uint8_t i = 0; i < 4; i++) {
+        if (!analisar_numero(argumentos[i], &valores[i])) {
+            printf("erro uso: params <a> <b> <c> <d>\n");
+            return;
+        }
+    }
+    parar_animacao(sistema);
+    memcpy(sistema->parametros, valores, sizeof(valores));
+    printf("ok params\n");
+}
+
+static void comando_zoom(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    float zoom;
+    if (!analisar_numero(argumentos[0], &zoom) || zoom < 0.1f || zoom > 10.0f) {
+        printf("erro zoom deve estar entre 0.1 e 10\n");
+        return;
+    }
+    sistema->nivel_zoom = zoom;
+    atualizar_brilho_zoom();
+    printf("ok zoom %s\n", texto_decimal(zoom, 3));
+}
+
+static void comando_centro(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    float centro;
+    if (!analisar_numero(argumentos[0], &centro)) {
+        printf("erro centro invalido\n");
+        return;
+    }
+    sistema->posicao_central_x = centro;
+    printf("ok centro %s\n", texto_decimal(centro, 3));
+}
+
+static void comando_escala_y(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    float fator;
+    if (!analisar_numero(argumentos[0], &fator) || fator < 0.001f || fator > 1000.0f) {
+        printf("erro escala_y deve estar entre 0.001 e 1000\n");
+        return;
+    }
+    sistema->fator_escala_y = fator;
+    printf("ok escala_y %s\n", texto_decimal(fator, 3));
+}
+
+static void comando_centro_y(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    float centro;
+    if (!analisar_numero(argumentos[0], &centro) || centro < -10000.0f || centro > 10000.0f) {
+        printf("erro centro_y deve estar entre -10000 e 10000\n");
+        return;
+    }
+    sistema->posicao_central_y = centro;
+    printf("ok centro_y %s\n", texto_decimal(centro, 3));
+}
+
+// Enquadra a curva: "ajustar" calcula a vista, "ajustar 0" volta à padrão
+static void comando_ajustar(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t ajustar = 1;
+    if (quantidade > 0 && !analisar_inteiro(argumentos[0], 0, 1, &ajustar)) {
+        printf("erro uso: ajustar [0|1]\n");
+        return;
+    }
+
+    if (!ajustar) {
+        restaurar_vista(sistema);
+        if (sistema->estado_atual == ESTADO_EXIBIR_GRAFICO) {
+            plotar_grafico_selecionado(sistema);
+        }
+    } else if (sistema->estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        ajustar_vista(sistema);
+    } else {
+        printf("erro ajustar exige a tela do grafico\n");
+        return;
+    }
+    printf("ok ajustar escala_y=%s centro_y=%s\n", texto_decimal(sistema->fator_escala_y, 3),
+           texto_decimal(sistema->posicao_central_y, 3));
+}
+
+// Renderiza o gráfico n vezes e informa tempo e bytes I2C por renderização
+static void comando_render(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t repeticoes = 1;
+    if (quantidade > 0 && !analisar_inteiro(argumentos[0], 1, RENDER_MAX_REPETICOES, &repeticoes)) {
+        printf("erro repeticoes entre 1 e %d\n", RENDER_MAX_REPETICOES);
+        return;
+    }
+
+    parar_animacao(sistema);
+    definir_estado(sistema, ESTADO_EXIBIR_GRAFICO);
+
+    uint32_t minimo_us = UINT32_MAX, maximo_us = 0;
+    uint64_t total_us = 0;
+    uint32_t bytes_antes = sistema->tela.bytes_enviados;
+    uint32_t transacoes_antes = sistema->tela.transacoes;
+
+    for (int32_t i = 0; i < repeticoes; i++) {
+        uint32_t inicio = time_us_32();
+        plotar_grafico_selecionado(sistema);
+        uint32_t duracao = time_us_32() - inicio;
+
+        total_us += duracao;
+        if (duracao < minimo_us) minimo_us = duracao;
+        if (duracao > maximo_us) maximo_us = duracao;
+    }
+
+    printf("ok render n=%d us_min=%u us_medio=%u us_max=%u i2c_bytes=%u i2c_transacoes=%u",
+           (int)repeticoes, (unsigned)minimo_us, (unsigned)(total_us / repeticoes), (unsigned)maximo_us,
+           (unsigned)((sistema->tela.bytes_enviados - bytes_antes) / repeticoes),
+           (unsigned)((sistema->tela.transacoes - transacoes_antes) / repeticoes));
+    if (!funcao_cartesiana(sistema->funcao_selecionada)) {
+        // Curvas traçadas por segmentos: pontos aceitos e passos refeitos
+        const EstatisticasCurva *curva = curva_estatisticas();
+        printf(" pontos=%u rejeitados=%u", (unsigned)curva->pontos, (unsigned)curva->rejeitados);
+    }
+    printf("\n");
+}
+
+static void comando_menu(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    parar_animacao(sistema);
+    definir_estado(sistema, ESTADO_MENU);
+    desenhar_tela_menu(sistema);
+    printf("ok menu\n");
+}
+
+static void comando_estado(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    printf("ok estado=%d funcao=%d params=%s,%s,%s,%s zoom=%s centro=%s escala_y=%s centro_y=%s "
+           "i2c_bytes=%u\n",
+           sistema->estado_atual, sistema->funcao_selecionada,
+           texto_decimal(sistema->parametros[0], 3), texto_decimal(sistema->parametros[1], 3),
+           texto_decimal(sistema->parametros[2], 3), texto_decimal(sistema->parametros[3], 3),
+           texto_decimal(sistema->nivel_zoom, 3), texto_decimal(sistema->posicao_central_x, 3),
+           texto_decimal(sistema->fator_escala_y, 3), texto_decimal(sistema->posicao_central_y, 3),
+           (unsigned)sistema->tela.bytes_enviados);
+}
+
+static void comando_transmissao(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t habilitar;
+    if (!analisar_inteiro(argumentos[0], 0, 1, &habilitar)) {
+        printf("erro uso: transmissao <0|1>\n");
+        return;
+    }
+    transmissao_habilitar(habilitar);
+    printf("ok transmissao %d\n", (int)habilitar);
+}
+
+static void comando_ocioso(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t tempo_ms;
+    if (!analisar_inteiro(argumentos[0], 0, 3600000, &tempo_ms)) {
+        printf("erro uso: ocioso <ms> (0 desativa)\n");
+        return;
+    }
+    energia_definir_tempo_ocioso(tempo_ms);
+    printf("ok ocioso %d\n", (int)tempo_ms);
+}
+
+static void comando_energia(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    energia_relatar();
+}
+
+// Sem argumento informa o modo; com 1 mostra o gráfico em tons de cinza
+static void comando_cinza(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (quantidade == 0) {
+        if (escala_cinza_ativa()) {
+            escala_cinza_relatar(&sistema->tela);
+        }
+        printf("ok cinza %d\n", escala_cinza_ativa());
+        return;
+    }
+
+    int32_t ativar;
+    if (!analisar_inteiro(argumentos[0], 0, 1, &ativar)) {
+        printf("erro uso: cinza [0|1]\n");
+        return;
+    }
+    if (ativar) {
+        definir_estado(sistema, ESTADO_EXIBIR_GRAFICO);
+    }
+    if (definir_escala_cinza(sistema, ativar) != (bool)ativar) {
+        printf("erro orcamento de %d fps nao sustentado\n", ESCALA_CINZA_FPS);
+        return;
+    }
+    printf("ok cinza %d\n", (int)ativar);
+}
+
+// Amostragem do PC pelo SysTick; o despejo é lido por ferramentas/perfil_simbolos.py
+static void comando_perfil(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (!perfilador_disponivel()) {
+        printf("erro perfilador nao compilado (opcao PERFILADOR do CMake)\n");
+        return;
+    }
+
+    if (strcmp(argumentos[0], "iniciar") == 0) {
+        int32_t frequencia = PERFILADOR_FREQUENCIA_PADRAO_HZ;
+        if (quantidade > 1 && !analisar_inteiro(argumentos[1], 10, 100000, &frequencia)) {
+            printf("erro frequencia entre 10 e 100000 Hz\n");
+            return;
+        }
+        perfilador_zerar();
+        if (!perfilador_iniciar(frequencia)) {
+            printf("erro frequencia invalida\n");
+            return;
+        }
+        printf("ok perfil iniciar %d\n", (int)frequencia);
+    } else if (strcmp(argumentos[0], "parar") == 0) {
+        perfilador_parar();
+        printf("ok perfil parar\n");
+    } else if (strcmp(argumentos[0], "despejar") == 0) {
+        perfilador_despejar();
+        printf("ok perfil despejar\n");
+    } else {
+        printf("erro uso: perfil <iniciar [hz]|parar|despejar>\n");
+    }
+}
+
+// Liga/desliga a gravação ou exporta o rastro em um quadro binário
+static void comando_rastro(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t habilitar;
+    if (strcmp(argumentos[0], "despejar") == 0) {
+        rastro_despejar();
+        printf("ok rastro despejar\n");
+    } else if (analisar_inteiro(argumentos[0], 0, 1, &habilitar)) {
+        rastro_habilitar(habilitar);
+        printf("ok rastro %d\n", (int)habilitar);
+    } else {
+        printf("erro uso: rastro <0|1|despejar>\n");
+    }
+}
+
+// sessao inicio <estado> <funcao> <indice> <a> <b> <c> <d> <zoom> <centro>
+static void carregar_inicio_sessao(char **argumentos, uint8_t quantidade) {
+    EstadoInicialSessao inicio = *sessao_inicio();
+    int32_t estado, funcao, indice;
+    float valores[6];
+
+    bool valido = quantidade == 10 &&
+                  analisar_inteiro(argumentos[1], ESTADO_MENU, ESTADO_OSCILOSCOPIO, &estado) &&
+                  analisar_inteiro(argumentos[2], 0, TOTAL_FUNCOES - 1, &funcao) &&
+                  analisar_inteiro(argumentos[3], 0, 3, &indice);
+    for (uint8_t i = 0; valido && i < 6; i++) {
+        valido = analisar_numero(argumentos[4 + i], &valores[i]);
+    }
+    if (!valido) {
+        printf("erro uso: sessao inicio <estado> <funcao> <indice> <a> <b> <c> <d> <zoom> <centro>\n");
+        return;
+    }
+
+    inicio.estado = (EstadoSistema)estado;
+    inicio.funcao = (TipoFuncao)funcao;
+    inicio.indice_parametro = indice;
+    for (uint8_t i = 0; i < 4; i++) {
+        inicio.parametros[i] = valores[i];
+    }
+    inicio.zoom = valores[4];
+    inicio.centro_x = valores[5];
+    sessao_definir_inicio(&inicio);
+    printf("ok sessao inicio\n");
+}
+
+// sessao vista <centro_y> <escala_y> <cursor> <coluna> <analise> <x0> <x1> <passo_tabela>
+static void carregar_vista_sessao(char **argumentos, uint8_t quantidade) {
+    EstadoInicialSessao inicio = *sessao_inicio();
+    int32_t cursor, coluna, analise, passo;
+    float valores[4];
+
+    bool valido = quantidade == 9 &&
+                  analisar_numero(argumentos[1], &valores[0]) &&
+                  analisar_numero(argumentos[2], &valores[1]) && valores[1] >= 0.001f && valores[1] <= 1000.0f &&
+                  analisar_inteiro(argumentos[3], 0, 1, &cursor) &&
+                  analisar_inteiro(argumentos[4], 0, SSD1306_LARGURA - 1, &coluna) &&
+                  analisar_inteiro(argumentos[5], 0, 1, &analise) &&
+                  analisar_numero(argumentos[6], &valores[2]) &&
+                  analisar_numero(argumentos[7], &valores[3]) &&
+                  analisar_inteiro(argumentos[8], 0, TABELA_TOTAL_PASSOS - 1, &passo);
+    if (!valido) {
+        printf("erro uso: sessao vista <centro_y> <escala_y> <cursor> <coluna> <analise> <x0> <x1> <passo_tabela>\n");
+        return;
+    }
+
+    inicio.centro_y = valores[0];
+    inicio.escala_y = valores[1];
+    inicio.cursor_ativo = cursor;
+    inicio.cursor_coluna = coluna;
+    inicio.analise_ativa = analise;
+    inicio.analise_x_inicio = valores[2];
+    inicio.analise_x_fim = valores[3];
+    inicio.indice_passo_tabela = passo;
+    sessao_definir_inicio(&inicio);
+    printf("ok sessao vista\n");
+}
+
+// sessao captura <canal> <taxa> <borda> <nivel>
+static void carregar_captura_sessao(char **argumentos, uint8_t quantidade) {
+    EstadoInicialSessao inicio = *sessao_inicio();
+    int32_t canal, borda, nivel;
+    uint32_t taxa;
+
+    bool valido = quantidade == 5 &&
+                  analisar_inteiro(argumentos[1], 0, 2, &canal) &&
+                  analisar_natural(argumentos[2], &taxa) &&
+                  analisar_inteiro(argumentos[3], 0, TOTAL_GATILHOS - 1, &borda) &&
+                  analisar_inteiro(argumentos[4], 0, OSC_NIVEL_MAXIMO, &nivel);
+    if (!valido) {
+        printf("erro uso: sessao captura <canal> <taxa> <borda> <nivel>\n");
+        return;
+    }
+
+    inicio.osc_canal = canal;
+    inicio.osc_taxa = taxa;
+    inicio.osc_borda = borda;
+    inicio.osc_nivel = nivel;
+    sessao_definir_inicio(&inicio);
+    printf("ok sessao captura\n");
+}
+
+// sessao entrada <instante_us> <tipo> <argumento> <valor>
+static void carregar_entrada_sessao(char **argumentos, uint8_t quantidade) {
+    uint32_t campos[4];
+    bool valido = quantidade == 5;
+    for (uint8_t i = 0; valido && i < 4; i++) {
+        valido = analisar_natural(argumentos[1 + i], &campos[i]);
+    }
+    if (!valido || campos[1] < ENTRADA_BOTAO || campos[1] > ENTRADA_ADC || campos[2] > 0xFF || campos[3] > 0xFFFF) {
+        printf("erro uso: sessao entrada <instante_us> <tipo> <argumento> <valor>\n");
+        return;
+    }
+
+    RegistroEntrada registro = {campos[0], campos[1], campos[2], campos[3]};
+    if (!sessao_adicionar(&registro)) {
+        printf("erro sessao cheia (%d entradas)\n", SESSAO_CAPACIDADE);
+        return;
+    }
+    printf("ok sessao entrada\n");
+}
+
+// Gravação e reprodução das entradas (ver ferramentas/sessao_entradas.py)
+static void comando_sessao(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    uint32_t duracao;
+
+    if (strcmp(argumentos[0], "gravar") == 0) {
+        sessao_gravar(sistema);
+        printf("ok sessao gravar\n");
+    } else if (strcmp(argumentos[0], "parar") == 0) {
+        sessao_parar();
+        printf("ok sessao parar\n");
+    } else if (strcmp(argumentos[0], "reproduzir") == 0) {
+        sessao_parar();
+        sessao_reproduzir(sistema);
+        printf("ok sessao reproduzir\n");
+    } else if (strcmp(argumentos[0], "despejar") == 0) {
+        sessao_despejar();
+        printf("ok sessao despejar\n");
+    } else if (strcmp(argumentos[0], "carregar") == 0) {
+        sessao_limpar();
+        printf("ok sessao carregar\n");
+    } else if (strcmp(argumentos[0], "inicio") == 0) {
+        carregar_inicio_sessao(argumentos, quantidade);
+    } else if (strcmp(argumentos[0], "vista") == 0) {
+        carregar_vista_sessao(argumentos, quantidade);
+    } else if (strcmp(argumentos[0], "captura") == 0) {
+        carregar_captura_sessao(argumentos, quantidade);
+    } else if (strcmp(argumentos[0], "entrada") == 0) {
+        carregar_entrada_sessao(argumentos, quantidade);
+    } else if (strcmp(argumentos[0], "duracao") == 0 && quantidade == 2 && analisar_natural(argumentos[1], &duracao)) {
+        sessao_definir_duracao(duracao);
+        printf("ok sessao duracao\n");
+    } else {
+        printf("erro uso: sessao <gravar|parar|reproduzir|despejar|carregar>\n");
+    }
+}
+
+// "tabela" abre a tabela de valores; "tabela <n>" rola n linhas e informa o custo
+static void comando_tabela(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    int32_t linhas = 0;
+    if (quantidade > 0 && !analisar_inteiro(argumentos[0], -100000, 100000, &linhas)) {
+        printf("erro uso: tabela [linhas]\n");
+        return;
+    }
+
+    if (!funcao_cartesiana(sistema->funcao_selecionada)) {
+        printf("erro tabela so para y = f(x)\n");
+        return;
+    }
+
+    uint32_t inicio = time_us_32();
+    uint32_t bytes_antes = sistema->tela.bytes_enviados;
+    uint32_t avaliacoes_antes = sistema->tabela.avaliacoes;
+    if (sistema->estado_atual != ESTADO_EXIBIR_TABELA) {
+        parar_animacao(sistema);
+        definir_estado(sistema, ESTADO_EXIBIR_TABELA);
+        iniciar_tabela(sistema);
+    }
+    rolar_tabela(sistema, linhas);
+    printf("ok tabela primeira=%d passo=%s us=%u i2c_bytes=%u avaliacoes=%u\n",
+           (int)sistema->tabela.primeira_linha, texto_decimal(sistema->tabela.passo, 3), (unsigned)(time_us_32() - inicio),
+           (unsigned)(sistema->tela.bytes_enviados - bytes_antes),
+           (unsigned)(sistema->tabela.avaliacoes - avaliacoes_antes));
+}
+
+// "cursor 0|1" desliga/liga o cursor; "cursor mover <n>" anda n colunas
+static void comando_cursor(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (strcmp(argumentos[0], "mover") == 0) {
+        int32_t colunas;
+        if (quantidade < 2 || !analisar_inteiro(argumentos[1], -(SSD1306_LARGURA - 1), SSD1306_LARGURA - 1, &colunas)) {
+            printf("erro uso: cursor mover <colunas>\n");
+            return;
+        }
+        if (!sistema->cursor_ativo) {
+            printf("erro cursor desligado\n");
+            return;
+        }
+        uint32_t inicio = time_us_32();
+        uint32_t bytes_antes = sistema->tela.bytes_enviados;
+        mover_cursor(sistema, (int16_t)colunas);
+        printf("ok cursor coluna=%u us=%u i2c_bytes=%u\n", sistema->cursor_coluna,
+               (unsigned)(time_us_32() - inicio), (unsigned)(sistema->tela.bytes_enviados - bytes_antes));
+        return;
+    }
+
+    int32_t ativar;
+    if (!analisar_inteiro(argumentos[0], 0, 1, &ativar)) {
+        printf("erro uso: cursor <0|1|mover n>\n");
+        return;
+    }
+    if (ativar && sistema->estado_atual != ESTADO_EXIBIR_GRAFICO) {
+        printf("erro cursor exige a tela do grafico\n");
+        return;
+    }
+    if (definir_cursor(sistema, ativar) != (bool)ativar) {
+        printf("erro cursor so para y = f(x)\n");
+        return;
+    }
+    printf("ok cursor %d\n", (int)ativar);
+}
+
+// "analise" informa a integral; "analise 0|1 [x0 x1]" desliga/liga a
+// sobreposição, opcionalmente com novos limites
+static void comando_analise(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (quantidade > 0) {
+        int32_t ativar;
+        float limites[2];
+        if (!analisar_inteiro(argumentos[0], 0, 1, &ativar) || quantidade == 2 ||
+            (quantidade > 2 && (!analisar_numero(argumentos[1], &limites[0]) ||
+                                !analisar_numero(argumentos[2], &limites[1])))) {
+            printf("erro uso: analise [0|1 [x0 x1]]\n");
+            return;
+        }
+        if (quantidade > 2) {
+            definir_limites_analise(sistema, limites[0], limites[1]);
+        }
+        if (definir_analise(sistema, ativar) != (bool)ativar) {
+            printf("erro analise so para y = f(x)\n");
+            return;
+        }
+    }
+
+    const Analise *analise = &sistema->analise;
+    printf("ok analise ativa=%d x0=%s x1=%s integral=%s aproximada=%d\n", analise->ativa,
+           texto_decimal(analise->x_inicio, 3), texto_decimal(analise->x_fim, 3),
+           texto_decimal(analise->integral, 4), analise->aproximada);
+}
+
+// "led envio 0|1" liga o sinal de envio de quadros; "led respirar|piscar
+// [ms]" testa o efeito em branco e "led fixo" volta à cor da função
+static void comando_led(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (strcmp(argumentos[0], "envio") == 0) {
+        int32_t habilitar;
+        if (quantidade < 2 || !analisar_inteiro(argumentos[1], 0, 1, &habilitar)) {
+            printf("erro uso: led envio <0|1>\n");
+            return;
+        }
+        led_rgb_habilitar_sinal_envio(habilitar);
+        printf("ok led envio=%d\n", (int)habilitar);
+        return;
+    }
+    if (strcmp(argumentos[0], "fixo") == 0) {
+        atualizar_brilho_zoom();
+        printf("ok led fixo\n");
+        return;
+    }
+
+    bool respirar = strcmp(argumentos[0], "respirar") == 0;
+    int32_t periodo = 1000;
+    if ((!respirar && strcmp(argumentos[0], "piscar") != 0) ||
+        (quantidade > 1 && !analisar_inteiro(argumentos[1], 2, 60000, &periodo))) {
+        printf("erro uso: led <fixo|respirar [ms]|piscar [ms]|envio 0|1>\n");
+        return;
+    }
+    CorRgb cor = {255, 255, 255};
+    if (respirar) {
+        led_rgb_respirar(cor, (uint16_t)periodo);
+    } else {
+        led_rgb_piscar(cor, (uint16_t)periodo);
+    }
+    printf("ok led %s periodo=%d\n", argumentos[0], (int)periodo);
+}
+
+// Pilhas (marca d'água), heap e seções estáticas
+static void comando_memoria(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    memoria_relatar();
+    printf("ok memoria\n");
+}
+
+// Linha do tempo da última partida
+static void comando_partida(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    partida_imprimir();
+    printf("ok partida\n");
+}
+
+// "cache" informa e zera as estatísticas; "cache 0|1" desliga/liga o cache
+static void comando_cache(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (quantidade > 0) {
+        int32_t habilitar;
+        if (!analisar_inteiro(argumentos[0], 0, 1, &habilitar)) {
+            printf("erro uso: cache [0|1]\n");
+            return;
+        }
+        cache_amostras_habilitar(habilitar);
+    }
+
+    const EstatisticasCache *e = cache_amostras_estatisticas();
+    uint32_t consultas = e->avaliados + e->reaproveitados;
+    printf("ok cache habilitado=%d avaliados=%u reaproveitados=%u aproveitamento=%u%% descartes=%u diretas=%u\n",
+           cache_amostras_habilitado(), (unsigned)e->avaliados, (unsigned)e->reaproveitados,
+           (unsigned)(consultas ? (uint64_t)e->reaproveitados * 100 / consultas : 0),
+           (unsigned)e->descartes, (unsigned)e->diretas);
+    cache_amostras_zerar_estatisticas();
+}
+
+// "prerender" informa e zera os contadores; "prerender 0|1" desliga/liga
+// a preparação do gráfico durante a configuração
+static void comando_prerender(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    if (quantidade > 0) {
+        int32_t habilitar;
+        if (!analisar_inteiro(argumentos[0], 0, 1, &habilitar)) {
+            printf("erro uso: prerender [0|1]\n");
+            return;
+        }
+        pre_renderizacao_habilitar(habilitar);
+    }
+
+    const EstatisticasPreRender *e = pre_renderizacao_estatisticas();
+    printf("ok prerender habilitado=%d concluidos=%u cancelados=%u aproveitados=%u descartados=%u\n",
+           pre_renderizacao_habilitada(), (unsigned)e->concluidos, (unsigned)e->cancelados,
+           (unsigned)e->aproveitados, (unsigned)e->descartados);
+    pre_renderizacao_zerar_estatisticas();
+}
+
+// "osc" informa e zera os contadores da captura; "osc 0|1" sai/entra no
+// modo osciloscópio; taxa, canal e gatilho valem também com ele desligado
+static void comando_osc(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    static const char *const bordas[TOTAL_GATILHOS] = {"subida", "descida", "livre"};
+
+    if (quantidade > 0 && strcmp(argumentos[0], "taxa") == 0) {
+        uint32_t taxa;
+        if (quantidade < 2 || !analisar_natural(argumentos[1], &taxa)) {
+            printf("erro uso: osc taxa <hz>\n");
+            return;
+        }
+        printf("ok osc taxa=%u maxima=%u\n", (unsigned)osciloscopio_definir_taxa(taxa),
+               (unsigned)osciloscopio_taxa_maxima());
+        return;
+    }
+    if (quantidade > 0 && strcmp(argumentos[0], "canal") == 0) {
+        int32_t canal;
+        if (quantidade < 2 || !analisar_inteiro(argumentos[1], 0, 2, &canal) ||
+            !osciloscopio_definir_canal((uint)canal)) {
+            printf("erro uso: osc canal <0-2>\n");
+            return;
+        }
+        printf("ok osc canal=%d\n", (int)canal);
+        return;
+    }
+    if (quantidade > 0 && strcmp(argumentos[0], "gatilho") == 0) {
+        int32_t borda = -1;
+        for (int32_t i = 0; quantidade > 1 && i < TOTAL_GATILHOS; i++) {
+            if (strcmp(argumentos[1], bordas[i]) == 0) {
+                borda = i;
+            }
+        }
+        float volts = osciloscopio_nivel() * OSC_TENSAO_REFERENCIA / (OSC_NIVEL_MAXIMO + 1);
+        if (borda < 0 || (quantidade > 2 && !analisar_numero(argumentos[2], &volts)) ||
+            volts < 0.0f || volts > OSC_TENSAO_REFERENCIA) {
+            printf("erro uso: osc gatilho <subida|descida|livre> [0-3.3 V]\n");
+            return;
+        }
+        osciloscopio_definir_gatilho((BordaGatilho)borda,
+                                     (uint16_t)(volts * (OSC_NIVEL_MAXIMO + 1) / OSC_TENSAO_REFERENCIA));
+        printf("ok osc gatilho=%s nivel=%s\n", bordas[borda], texto_decimal(volts, 2));
+        return;
+    }
+    if (quantidade > 0) {
+        int32_t ativar;
+        if (!analisar_inteiro(argumentos[0], 0, 1, &ativar)) {
+            printf("erro uso: osc [0|1|taxa <hz>|canal <0-2>|gatilho <borda> [V]]\n");
+            return;
+        }
+        if (ativar && sistema->estado_atual != ESTADO_OSCILOSCOPIO) {
+            iniciar_osciloscopio(sistema);
+        } else if (!ativar && sistema->estado_atual == ESTADO_OSCILOSCOPIO) {
+            definir_estado(sistema, ESTADO_MENU);
+            desenhar_tela_menu(sistema);
+        }
+    }
+
+    const EstatisticasOsciloscopio *e = osciloscopio_estatisticas();
+    printf("ok osc ativo=%d canal=%u taxa=%u gatilho=%s nivel=%s blocos=%u atrasos=%u quadros=%u exibidos=%u automaticos=%u\n",
+           osciloscopio_ativo(), osciloscopio_canal(), (unsigned)osciloscopio_taxa(), bordas[osciloscopio_borda()],
+           texto_decimal(osciloscopio_nivel() * OSC_TENSAO_REFERENCIA / (OSC_NIVEL_MAXIMO + 1), 2),
+           (unsigned)e->blocos, (unsigned)e->atrasos, (unsigned)e->quadros, (unsigned)e->entregues,
+           (unsigned)e->automaticos);
+    osciloscopio_zerar_estatisticas();
+}
+
+static void comando_ajuda(Sistema *sistema, char **argumentos, uint8_t quantidade);
+
+static const Comando comandos[] = {
+    {"funcao", 1, comando_funcao, "funcao <0-5>"},
+    {"param", 2, comando_param, "param <A-D> <valor>"},
+    {"params", 4, comando_params, "params <a> <b> <c> <d>"},
+    {"zoom", 1, comando_zoom, "zoom <0.1-10>"},
+    {"centro", 1, comando_centro, "centro <x>"},
+    {"escala_y", 1, comando_escala_y, "escala_y <0.001-1000>"},
+    {"centro_y", 1, comando_centro_y, "centro_y <-10000-10000>"},
+    {"ajustar", 0, comando_ajustar, "ajustar [0|1]"},
+    {"render", 0, comando_render, "render [repeticoes]"},
+    {"menu", 0, comando_menu, "menu"},
+    {"estado", 0, comando_estado, "estado"},
+    {"transmissao", 1, comando_transmissao, "transmissao <0|1>"},
+    {"ocioso", 1, comando_ocioso, "ocioso <ms>"},
+    {"energia", 0, comando_energia, "energia"},
+    {"cinza", 0, comando_cinza, "cinza [0|1]"},
+    {"perfil", 1, comando_perfil, "perfil <iniciar [hz]|parar|despejar>"},
+    {"rastro", 1, comando_rastro, "rastro <0|1|despejar>"},
+    {"sessao", 1, comando_sessao, "sessao <gravar|parar|reproduzir|despejar|carregar>"},
+    {"tabela", 0, comando_tabela, "tabela [linhas]"},
+    {"cursor", 1, comando_cursor, "cursor <0|1|mover n>"},
+    {"analise", 0, comando_analise, "analise [0|1 [x0 x1]]"},
+    {"cache", 0, comando_cache, "cache [0|1]"},
+    {"prerender", 0, comando_prerender, "prerender [0|1]"},
+    {"osc", 0, comando_osc, "osc [0|1|taxa <hz>|canal <0-2>|gatilho <borda> [V]]"},
+    {"partida", 0, comando_partida, "partida"},
+    {"memoria", 0, comando_memoria, "memoria"},
+    {"led", 1, comando_led, "led <fixo|respirar [ms]|piscar [ms]|envio 0|1>"},
+    {"ajuda", 0, comando_ajuda, "ajuda"},
+};
+
+#define TOTAL_COMANDOS (sizeof(comandos) / sizeof(comandos[0]))
+
+static void comando_ajuda(Sistema *sistema, char **argumentos, uint8_t quantidade) {
+    for (uint8_t i = 0; i < TOTAL_COMANDOS; i++) {
+        printf("  %s\n", comandos[i].ajuda);
+    }
+    printf("ok ajuda\n");
+}
+
+// Separa a linha em palavras no próprio buffer e executa o comando
+static void executar_linha(Sistema *sistema) {
+    char *argumentos[COMANDO_MAX_ARGUMENTOS + 1];
+    uint8_t quantidade = 0;
+    char *cursor = linha;
+
+    while (*cursor != '\0' && quantidade <= COMANDO_MAX_ARGUMENTOS) {
+        while (*cursor == ' ' || *cursor == '\t') *cursor++ = '\0';
+        if (*cursor == '\0') break;
+        argumentos[quantidade++] = cursor;
+        while (*cursor != '\0' && *cursor != ' ' && *cursor != '\t') cursor++;
+    }
+
+    if (quantidade == 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < TOTAL_COMANDOS; i++) {
+        if (strcmp(argumentos[0], comandos[i].nome) == 0) {
+            if (quantidade - 1 < comandos[i].minimo_argumentos) {
+                printf("erro uso: %s\n", comandos[i].ajuda);
+            } else {
+                comandos[i].executar(sistema, &argumentos[1], quantidade - 1);
+            }
+            return;
+        }
+    }
+    printf("erro comando desconhecido: %s\n", argumentos[0]);
+}
+
+// Consome os caracteres já recebidos sem bloquear o laço principal
+void processar_comandos_usb(Sistema *sistema) {
+    int caractere;
+
+    while ((caractere = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (caractere == '\r' || caractere == '\n') {
+            linha[tamanho_linha] = '\0';
+            if (linha_longa) {
+                printf("erro linha muito longa\n");
+            } else {
+                executar_linha(sistema);
+            }
+            tamanho_linha = 0;
+            linha_longa = false;
+        } else if (tamanho_linha < COMANDO_TAMANHO_MAXIMO - 1) {
+            linha[tamanho_linha++] = (char)caractere;
+        } else {
+            linha_longa = true;
+        }
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef COMANDOS_USB_H
+#define COMANDOS_USB_H
+
+#include "funcoes_graficas.h"
+
+// Interpretador de comandos de texto recebidos pela stdio (USB CDC).
+// Cada linha gera uma resposta iniciada por "ok" ou "erro".
+void processar_comandos_usb(Sistema *sistema);
+
+#endif // COMANDOS_USB_H
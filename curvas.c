@@ -0,0 +1,171 @@
+#include "curvas.h"
+#include <math.h>
+
+#define DOIS_PI 6.28318530718f
+#define UNIDADES_POR_PASSO_MAXIMO (1u << (CURVA_NIVEIS - 1))
+#define RENORMALIZAR_A_CADA 32
+
+static EstatisticasCurva ultimas_estatisticas;
+
+// Seno e cosseno de um ângulo que avança por rotação: girar por (sen a, cos a)
+// soma a ao ângulo com 4 multiplicações
+typedef struct {
+    float s;
+    float c;
+} Oscilador;
+
+static inline void oscilador_iniciar(Oscilador *o, float angulo) {
+    o->s = sinf(angulo);
+    o->c = cosf(angulo);
+}
+
+static inline Oscilador oscilador_girar(const Oscilador *o, const Oscilador *passo) {
+    Oscilador girado = {
+        o->s * passo->c + o->c * passo->s,
+        o->c * passo->c - o->s * passo->s
+    };
+    return girado;
+}
+
+// Corrige o desvio acumulado do raio (aproximação de primeira ordem de 1/√r²)
+static inline void oscilador_renormalizar(Oscilador *o) {
+    float fator = 1.5f - 0.5f * (o->s * o->s + o->c * o->c);
+    o->s *= fator;
+    o->c *= fator;
+}
+
+// Rotações de cada nível de passo, calculadas só quando o nível é usado
+typedef struct {
+    bool calculado[CURVA_NIVEIS];
+    Oscilador base[CURVA_NIVEIS];       // Ângulo t
+    Oscilador harmonico[CURVA_NIVEIS];  // Ângulo C·t
+} TabelaRotacoes;
+
+static const Oscilador *rotacao(TabelaRotacoes *tabela, uint8_t nivel, float frequencia, bool harmonico) {
+    if (!tabela->calculado[nivel]) {
+        float passo = DOIS_PI / CURVA_SEGMENTOS_MINIMOS / (float)(1u << nivel);
+        oscilador_iniciar(&tabela->base[nivel], passo);
+        oscilador_iniciar(&tabela->harmonico[nivel], frequencia * passo);
+        tabela->calculado[nivel] = true;
+    }
+    return harmonico ? &tabela->harmonico[nivel] : &tabela->base[nivel];
+}
+
+// Ponto da curva na tela a partir dos dois osciladores
+static void ponto_na_tela(const TransformacaoVista *v, TipoFuncao tipo, const float *p,
+                          const Oscilador *base, const Oscilador *harmonico, float *x, float *y) {
+    float mx, my;
+    if (tipo == FUNCAO_POLAR) {
+        float r = p[0] + p[1] * harmonico->c;
+        mx = r * base->c;
+        my = r * base->s;
+    } else {
+        mx = p[0] * harmonico->s;
+        my = p[1] * base->s;
+    }
+    *x = v->coluna_zero + mx * v->escala_x;
+    *y = v->linha_zero - my * v->escala_y;
+}
+
+// Região do ponto em relação à tela (Cohen–Sutherland)
+enum { DENTRO = 0, ESQUERDA = 1, DIREITA = 2, ACIMA = 4, ABAIXO = 8 };
+
+static uint8_t regiao(float x, float y) {
+    uint8_t codigo = DENTRO;
+    if (x < 0) codigo |= ESQUERDA;
+    else if (x > SSD1306_LARGURA - 1) codigo |= DIREITA;
+    if (y < 0) codigo |= ACIMA;
+    else if (y > SSD1306_ALTURA - 1) codigo |= ABAIXO;
+    return codigo;
+}
+
+// Recorta o segmento à tela e o traça com a rotina inteira de Bresenham
+static void desenhar_segmento(ssd1306_t *alvo, float x0, float y0, float x1, float y1) {
+    uint8_t c0 = regiao(x0, y0), c1 = regiao(x1, y1);
+    while (c0 | c1) {
+        if (c0 & c1) {
+            return;  // Inteiramente de um lado da tela
+        }
+        uint8_t fora = c0 ? c0 : c1;
+        float x, y;
+        if (fora & ABAIXO) {
+            x = x0 + (x1 - x0) * (SSD1306_ALTURA - 1 - y0) / (y1 - y0);
+            y = SSD1306_ALTURA - 1;
+        } else if (fora & ACIMA) {
+            x = x0 + (x1 - x0) * (0 - y0) / (y1 - y0);
+            y = 0;
+        } else if (fora & DIREITA) {
+            y = y0 + (y1 - y0) * (SSD1306_LARGURA - 1 - x0) / (x1 - x0);
+            x = SSD1306_LARGURA - 1;
+        } else {
+            y = y0 + (y1 - y0) * (0 - x0) / (x1 - x0);
+            x = 0;
+        }
+        if (fora == c0) {
+            x0 = x; y0 = y; c0 = regiao(x0, y0);
+        } else {
+            x1 = x; y1 = y; c1 = regiao(x1, y1);
+        }
+    }
+    ssd1306_line(alvo, (uint8_t)(x0 + 0.5f), (uint8_t)(y0 + 0.5f), (uint8_t)(x1 + 0.5f), (uint8_t)(y1 + 0.5f), true);
+}
+
+void curva_desenhar(ssd1306_t *alvo, const TransformacaoVista *vista, TipoFuncao tipo, const float *parametros) {
+    EstatisticasCurva *estatisticas = &ultimas_estatisticas;
+    const float frequencia = parametros[2];
+    TabelaRotacoes tabela = {0};
+    estatisticas->pontos = 0;
+    estatisticas->rejeitados = 0;
+
+    // t é contado em unidades do menor passo, assim a volta fecha exatamente
+    const uint32_t total = CURVA_SEGMENTOS_MINIMOS * UNIDADES_POR_PASSO_MAXIMO;
+    uint32_t t = 0;
+    uint8_t nivel = 2;
+
+    Oscilador base, harmonico;
+    oscilador_iniciar(&base, 0);
+    oscilador_iniciar(&harmonico, parametros[3]);
+    float x, y;
+    ponto_na_tela(vista, tipo, parametros, &base, &harmonico, &x, &y);
+
+    while (t < total) {
+        // t é sempre múltiplo do passo atual, então o último passo termina em total
+        uint32_t unidades = UNIDADES_POR_PASSO_MAXIMO >> nivel;
+
+        Oscilador nova_base = oscilador_girar(&base, rotacao(&tabela, nivel, frequencia, false));
+        Oscilador novo_harmonico = oscilador_girar(&harmonico, rotacao(&tabela, nivel, frequencia, true));
+        float nx, ny;
+        ponto_na_tela(vista, tipo, parametros, &nova_base, &novo_harmonico, &nx, &ny);
+
+        // Segmentos fora da tela (ambos os extremos do mesmo lado) não precisam de resolução
+        float distancia = fmaxf(fabsf(nx - x), fabsf(ny - y));
+        bool visivel = (regiao(x, y) & regiao(nx, ny)) == 0;
+        if (visivel && distancia > CURVA_DISTANCIA_MAXIMA && nivel < CURVA_NIVEIS - 1) {
+            nivel++;
+            estatisticas->rejeitados++;
+            continue;
+        }
+
+        if (visivel) {
+            desenhar_segmento(alvo, x, y, nx, ny);
+        }
+        base = nova_base;
+        harmonico = novo_harmonico;
+        x = nx;
+        y = ny;
+        t += unidades;
+        if (++estatisticas->pontos % RENORMALIZAR_A_CADA == 0) {
+            oscilador_renormalizar(&base);
+            oscilador_renormalizar(&harmonico);
+        }
+
+        // Só volta a um passo maior se a posição em t estiver alinhada a ele
+        if (distancia < CURVA_DISTANCIA_MINIMA && nivel > 0 && (t % (unidades << 1)) == 0) {
+            nivel--;
+        }
+    }
+}
+
+const EstatisticasCurva *curva_estatisticas(void) {
+    return &ultimas_estatisticas;
+}
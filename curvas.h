@@ -0,0 +1,26 @@
+#ifndef CURVAS_H
+#define CURVAS_H
+
+#include "funcoes_graficas.h"
+
+// Curvas parametrizadas por um ângulo t em [0, 2π]:
+//   paramétrica: x = A·sen(C·t + D), y = B·sen(t)  (Lissajous; A = B, C = 1, D = π/2 dá um círculo)
+//   polar:       r = A + B·cos(C·θ + D)           (rosáceas, cardioides)
+// O passo de t é adaptativo: dividido por 2 enquanto o segmento na tela passa
+// de CURVA_DISTANCIA_MAXIMA pixels e dobrado quando fica abaixo da mínima.
+// Senos e cossenos avançam por rotação, sem chamar sinf/cosf a cada ponto.
+#define CURVA_SEGMENTOS_MINIMOS 64    // Maior passo: 2π / 64
+#define CURVA_NIVEIS 12               // Menor passo: (2π / 64) / 2^11
+#define CURVA_DISTANCIA_MAXIMA 2.0f
+#define CURVA_DISTANCIA_MINIMA 0.5f
+
+typedef struct {
+    uint32_t pontos;       // Pontos aceitos (segmentos desenhados)
+    uint32_t rejeitados;   // Passos refeitos com metade do tamanho
+} EstatisticasCurva;
+
+// Desenha a curva no alvo usando a transformação da vista
+void curva_desenhar(ssd1306_t *alvo, const TransformacaoVista *vista, TipoFuncao tipo, const float *parametros);
+const EstatisticasCurva *curva_estatisticas(void);  // Do último traçado
+
+#endif // CURVAS_H
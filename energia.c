@@ -0,0 +1,90 @@
+#include "energia.h"
+#include <stdio.h>
+#include "agendador.h"
+#include "escala_cinza.h"
+#include "sessao.h"
+#include "led_rgb.h"
+#include "osciloscopio.h"
+
+static uint32_t tempo_ocioso_ms;             // 0 = nunca dormir
+static absolute_time_t ultima_atividade;
+static bool dormindo = false;
+
+// Latência do despertar: do evento até o display exibir o quadro guardado
+static uint32_t despertares = 0;
+static uint32_t latencia_ultima_us = 0;
+static uint32_t latencia_maxima_us = 0;
+
+void energia_iniciar(uint32_t tempo_ms) {
+    tempo_ocioso_ms = tempo_ms;
+    ultima_atividade = get_absolute_time();
+}
+
+void energia_definir_tempo_ocioso(uint32_t tempo_ms) {
+    tempo_ocioso_ms = tempo_ms;
+    ultima_atividade = get_absolute_time();
+}
+
+static void dormir(Sistema *sistema) {
+    // A GDDRAM do SSD1306 mantém o conteúdo com o display desligado
+    ssd1306_command(&sistema->tela, 0xAE);
+#if SEGUNDA_TELA_ATIVA
+    ssd1306_command(&sistema->painel_dados, 0xAE);
+#endif
+    led_rgb_suspender(true);
+    desligar_matriz();
+    dormindo = true;
+}
+
+static void despertar(Sistema *sistema) {
+    ssd1306_command(&sistema->tela, 0xAF);
+#if SEGUNDA_TELA_ATIVA
+    ssd1306_command(&sistema->painel_dados, 0xAF);
+#endif
+    led_rgb_suspender(false);
+    dormindo = false;
+
+    latencia_ultima_us = time_us_32() - agendador_instante_eventos();
+    if (latencia_ultima_us > latencia_maxima_us) {
+        latencia_maxima_us = latencia_ultima_us;
+    }
+    despertares++;
+    printf("Despertar: %u us do evento ao quadro\n", (unsigned)latencia_ultima_us);
+}
+
+// Registra um evento de entrada. Retorna true se ele só serviu para acordar
+// o sistema (o evento deve ser descartado).
+bool energia_registrar_atividade(Sistema *sistema) {
+    ultima_atividade = get_absolute_time();
+    if (dormindo) {
+        despertar(sistema);
+        return true;
+    }
+    return false;
+}
+
+// Tempo até o fim do período ocioso, para o prazo do agendador
+int64_t energia_prazo_ocioso_us(void) {
+    if (tempo_ocioso_ms == 0 || dormindo) {
+        return AGENDADOR_SEM_PRAZO;
+    }
+    int64_t restante = (int64_t)tempo_ocioso_ms * 1000 -
+                       absolute_time_diff_us(ultima_atividade, get_absolute_time());
+    return restante > 0 ? restante : 1;
+}
+
+void energia_verificar_ociosidade(Sistema *sistema) {
+    if (dormindo || tempo_ocioso_ms == 0 || sistema->animacao.ativa || escala_cinza_ativa() ||
+        osciloscopio_ativo() || sessao_reproduzindo()) {
+        return;
+    }
+    if (absolute_time_diff_us(ultima_atividade, get_absolute_time()) >= (int64_t)tempo_ocioso_ms * 1000) {
+        dormir(sistema);
+    }
+}
+
+void energia_relatar(void) {
+    printf("ok ocioso_ms=%u dormindo=%d despertares=%u despertar_us_ultimo=%u despertar_us_max=%u\n",
+           (unsigned)tempo_ocioso_ms, dormindo, (unsigned)despertares,
+           (unsigned)latencia_ultima_us, (unsigned)latencia_maxima_us);
+}
@@ -0,0 +1,16 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include "funcoes_graficas.h"
+
+// Tempo sem eventos de entrada até desligar display e LEDs
+#define TEMPO_OCIOSO_PADRAO_MS 30000
+
+void energia_iniciar(uint32_t tempo_ocioso_ms);
+void energia_definir_tempo_ocioso(uint32_t tempo_ocioso_ms);
+bool energia_registrar_atividade(Sistema *sistema);
+int64_t energia_prazo_ocioso_us(void);
+void energia_verificar_ociosidade(Sistema *sistema);
+void energia_relatar(void);
+
+#endif // ENERGIA_H
@@ -0,0 +1,174 @@
+#include "escala_cinza.h"
+#include <stdio.h>
+#include "ritmo_quadros.h"
+#include "transmissao_usb.h"
+#include "rastro.h"
+
+#define PALAVRAS_POR_PAGINA (SSD1306_LARGURA / 4)
+
+// Bit 0 e bit 1 do nível de cada pixel, no formato de páginas do display
+static uint32_t plano_baixo[CAMADA_PALAVRAS];
+static uint32_t plano_alto[CAMADA_PALAVRAS];
+
+static bool ativa = false;
+static bool planos_novos = false;   // Ainda não enviados pela transmissão USB
+static uint8_t subquadro = 0;
+static RitmoQuadros ritmo;          // Um "quadro" do ritmo é um subquadro
+static absolute_time_t inicio_relatorio;
+static uint32_t bytes_inicio_relatorio;
+
+void escala_cinza_ativar(ssd1306_t *tela) {
+    ativa = true;
+    subquadro = 0;
+    ritmo_iniciar(&ritmo, ESCALA_CINZA_FPS * ESCALA_CINZA_SUBQUADROS);
+#if ESCALA_CINZA_SINCRONIZAR_PAINEL
+    ssd1306_configurar_temporizacao(tela, ESCALA_CINZA_RELOGIO, ESCALA_CINZA_PRECARGA);
+#endif
+    inicio_relatorio = get_absolute_time();
+    bytes_inicio_relatorio = tela->bytes_enviados;
+}
+
+void escala_cinza_desativar(ssd1306_t *tela) {
+    if (!ativa) {
+        return;
+    }
+    ativa = false;
+#if ESCALA_CINZA_SINCRONIZAR_PAINEL
+    ssd1306_configurar_temporizacao(tela, SSD1306_RELOGIO_PADRAO, SSD1306_PRECARGA_PADRAO);
+#endif
+}
+
+bool escala_cinza_ativa(void) {
+    return ativa;
+}
+
+// Combina as camadas nos planos; o nível de cada camada vai de 0 a 3
+void escala_cinza_compor(camada_t *const camadas[], const uint8_t niveis[], uint8_t quantidade) {
+    for (uint16_t i = 0; i < CAMADA_PALAVRAS; i++) {
+        uint32_t baixo = 0, alto = 0;
+        for (uint8_t c = 0; c < quantidade; c++) {
+            uint32_t palavra = camada_pixels(camadas[c])[i];
+            if (niveis[c] & 1) baixo |= palavra;
+            if (niveis[c] & 2) alto |= palavra;
+        }
+        plano_baixo[i] = baixo;
+        plano_alto[i] = alto;
+    }
+    planos_novos = true;
+}
+
+// Subquadro k acende os pixels com nível > k: 1/3, 2/3 ou todo o tempo
+static inline uint32_t palavra_subquadro(uint8_t k, uint32_t baixo, uint32_t alto) {
+    switch (k) {
+        case 0: return baixo | alto;
+        case 1: return alto;
+        default: return baixo & alto;
+    }
+}
+
+// Monta o subquadro sobre o framebuffer (que guarda o que está no painel) e
+// envia, página a página, só o trecho entre a primeira e a última coluna alterada
+static void enviar_subquadro(ssd1306_t *tela) {
+    uint32_t *destino = (uint32_t *)(tela->ram_buffer + 1);
+    uint32_t bytes_antes = tela->bytes_enviados;
+    rastro_registrar(RASTRO_ENVIO_INICIO, subquadro, 0);
+
+    for (uint8_t pagina = 0; pagina < SSD1306_ALTURA / 8; pagina++) {
+        int8_t primeira = -1, ultima = -1;
+        for (uint8_t p = 0; p < PALAVRAS_POR_PAGINA; p++) {
+            uint16_t i = pagina * PALAVRAS_POR_PAGINA + p;
+            uint32_t palavra = palavra_subquadro(subquadro, plano_baixo[i], plano_alto[i]);
+            if (palavra != destino[i]) {
+                destino[i] = palavra;
+                if (primeira < 0) primeira = p;
+                ultima = p;
+            }
+        }
+        if (primeira >= 0) {
+            ssd1306_send_trecho(tela, pagina, primeira * 4, ultima * 4 + 3);
+        }
+    }
+
+    rastro_registrar(RASTRO_ENVIO_FIM, subquadro, tela->bytes_enviados - bytes_antes);
+
+    // O subquadro 0 equivale à imagem monocromática
+    if (subquadro == 0 && planos_novos) {
+        transmissao_enviar_tela(tela);
+        planos_novos = false;
+    }
+    subquadro = (subquadro + 1) % ESCALA_CINZA_SUBQUADROS;
+}
+
+static void proximo_subquadro(ssd1306_t *tela) {
+    ritmo_aguardar_quadro(&ritmo);
+    uint32_t inicio = time_us_32();
+    enviar_subquadro(tela);
+    ritmo_registrar_quadro(&ritmo, time_us_32() - inicio);
+}
+
+static void reiniciar_relatorio(ssd1306_t *tela) {
+    ritmo_zerar_estatisticas(&ritmo);
+    inicio_relatorio = get_absolute_time();
+    bytes_inicio_relatorio = tela->bytes_enviados;
+}
+
+// Informa o custo dos subquadros e se o orçamento de ESCALA_CINZA_FPS foi
+// cumprido (até 10% dos subquadros podem atrasar)
+bool escala_cinza_relatar(ssd1306_t *tela) {
+    uint32_t quadros = ritmo.quadros ? ritmo.quadros : 1;
+    unsigned media_us = (unsigned)(ritmo.duracao_total_us / quadros);
+    unsigned bytes = (unsigned)((tela->bytes_enviados - bytes_inicio_relatorio) / quadros);
+    unsigned capacidade_fps = ritmo.duracao_max_us ?
+        (unsigned)(1000000 / (ritmo.duracao_max_us * ESCALA_CINZA_SUBQUADROS)) : 0;
+    bool sustentado = (ritmo.estouros + ritmo.descartados) * 10 <= quadros;
+
+    printf("Escala de cinza: %u subquadros, envio medio %u us, max %u us (orcamento %u us), "
+           "%u bytes/subquadro, pior caso %u fps\n",
+           (unsigned)ritmo.quadros, media_us, (unsigned)ritmo.duracao_max_us,
+           (unsigned)ritmo.periodo_us, bytes, capacidade_fps);
+    if (!sustentado) {
+        printf("Escala de cinza: %u fps nao sustentados (%u atrasos, %u descartados)\n",
+               ESCALA_CINZA_FPS, (unsigned)ritmo.estouros, (unsigned)ritmo.descartados);
+    }
+    return sustentado;
+}
+
+// Mede alguns quadros seguidos com o conteúdo atual antes de manter o modo
+bool escala_cinza_verificar_orcamento(ssd1306_t *tela) {
+    reiniciar_relatorio(tela);
+    for (uint16_t i = 0; i < ESCALA_CINZA_QUADROS_TESTE * ESCALA_CINZA_SUBQUADROS; i++) {
+        proximo_subquadro(tela);
+    }
+    bool sustentado = escala_cinza_relatar(tela);
+    reiniciar_relatorio(tela);
+    return sustentado;
+}
+
+// Envia o próximo subquadro se o prazo chegou, sem bloquear o laço principal.
+// Retorna false se o modo foi desligado por estourar o orçamento.
+bool escala_cinza_atualizar(ssd1306_t *tela) {
+    if (!ativa) {
+        return false;
+    }
+    if (!time_reached(ritmo.proximo)) {
+        return true;
+    }
+
+    proximo_subquadro(tela);
+
+    if (absolute_time_diff_us(inicio_relatorio, get_absolute_time()) >= ESCALA_CINZA_RELATORIO_MS * 1000) {
+        bool sustentado = escala_cinza_relatar(tela);
+        reiniciar_relatorio(tela);
+        if (!sustentado) {
+            escala_cinza_desativar(tela);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Tempo até o próximo subquadro, para o prazo do agendador
+int64_t escala_cinza_prazo_us(void) {
+    int64_t restante = absolute_time_diff_us(get_absolute_time(), ritmo.proximo);
+    return restante > 0 ? restante : 0;
+}
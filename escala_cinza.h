@@ -0,0 +1,33 @@
+#ifndef ESCALA_CINZA_H
+#define ESCALA_CINZA_H
+
+#include "pico/stdlib.h"
+#include "Display_Bibliotecas/ssd1306.h"
+#include "Display_Bibliotecas/camadas.h"
+
+// Tons de cinza por modulação temporal: cada pixel tem 2 bits (0 a 3) em dois
+// planos e o display alterna 3 subquadros, acendendo no subquadro k os pixels
+// com nível > k. Só os trechos que mudam entre subquadros são enviados.
+#define ESCALA_CINZA_SUBQUADROS 3
+#define ESCALA_CINZA_FPS 60                 // Quadros de cinza completos por segundo
+#define ESCALA_CINZA_QUADROS_TESTE 20       // Quadros medidos na verificação do orçamento
+#define ESCALA_CINZA_RELATORIO_MS 2000
+
+// Oscilador no máximo e pré-carga curta: o painel varre mais rápido que os
+// subquadros, então cada um aparece inteiro pelo menos uma vez
+#ifndef ESCALA_CINZA_SINCRONIZAR_PAINEL
+#define ESCALA_CINZA_SINCRONIZAR_PAINEL 1
+#endif
+#define ESCALA_CINZA_RELOGIO 0xF0
+#define ESCALA_CINZA_PRECARGA 0x22
+
+void escala_cinza_ativar(ssd1306_t *tela);
+void escala_cinza_desativar(ssd1306_t *tela);
+bool escala_cinza_ativa(void);
+void escala_cinza_compor(camada_t *const camadas[], const uint8_t niveis[], uint8_t quantidade);
+bool escala_cinza_verificar_orcamento(ssd1306_t *tela);
+bool escala_cinza_atualizar(ssd1306_t *tela);
+int64_t escala_cinza_prazo_us(void);
+bool escala_cinza_relatar(ssd1306_t *tela);
+
+#endif // ESCALA_CINZA_H
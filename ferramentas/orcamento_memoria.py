@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""Orçamento de RAM e flash por módulo a partir do mapa do linker.
+
+Lê o menu_funcoes.elf.map gerado pelo build e soma o tamanho das seções de
+entrada de cada arquivo objeto: código e constantes contam na flash, .data
+conta na flash (valores iniciais) e na RAM, .bss só na RAM. Bibliotecas
+(.a) aparecem agrupadas pelo nome. Símbolos grandes podem ser separados do
+módulo que os define (por padrão a fonte do display, que vem de font.h).
+
+Com --limite-ram/--limite-flash o script termina com erro se o total passar
+do orçamento, o que permite usá-lo como verificação no build.
+
+Exemplos:
+    ./orcamento_memoria.py build/menu_funcoes.elf.map
+    ./orcamento_memoria.py build/menu_funcoes.elf.map --simbolo font=font.h --limite-ram 200000
+"""
+
+import argparse
+import collections
+import os
+import re
+import sys
+
+# Seções de saída do memmap_default.ld do SDK
+SECOES_FLASH = {".boot2", ".text", ".rodata", ".binary_info", ".ARM.extab", ".ARM.exidx"}
+SECOES_DATA = {".data", ".scratch_x", ".scratch_y"}
+SECOES_BSS = {".bss", ".ram_vector_table", ".uninitialized_data"}
+
+RAM_TOTAL = 264 * 1024
+FLASH_TOTAL = 2 * 1024 * 1024
+
+SECAO_SAIDA = re.compile(r"^(\.[\w.]+)\s")
+SECAO_ENTRADA = re.compile(r"^ (\.[\w.$]+|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*))?$")
+CONTINUACAO = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S.*)$")
+
+
+def nome_modulo(arquivo):
+    """Arquivo objeto -> módulo (ex.: .../funcoes_graficas.c.obj -> funcoes_graficas.c)."""
+    biblioteca = re.match(r"(.*\.a)\((.*)\)$", arquivo)
+    if biblioteca:
+        return os.path.basename(biblioteca.group(1))
+    nome = os.path.basename(arquivo)
+    for sufixo in (".obj", ".o"):
+        if nome.endswith(sufixo):
+            nome = nome[: -len(sufixo)]
+    if "pico-sdk" in arquivo or "pico_sdk" in arquivo:
+        return "pico-sdk"
+    return nome
+
+
+def ler_mapa(caminho, simbolos):
+    """Devolve {módulo: {"flash": n, "data": n, "bss": n}}."""
+    modulos = collections.defaultdict(lambda: collections.Counter())
+    saida = None
+    pendente = None
+    dentro_do_mapa = False
+
+    def somar(secao, tamanho, arquivo):
+        if saida in SECOES_FLASH:
+            categoria = "flash"
+        elif saida in SECOES_DATA:
+            categoria = "data"
+        elif saida in SECOES_BSS:
+            categoria = "bss"
+        else:
+            return
+        modulo = nome_modulo(arquivo)
+        for simbolo, destino in simbolos.items():
+            if secao.endswith("." + simbolo):
+                modulo = destino
+        modulos[modulo][categoria] += tamanho
+
+    with open(caminho) as mapa:
+        for linha in mapa:
+            linha = linha.rstrip("\n")
+            if not dentro_do_mapa:
+                dentro_do_mapa = linha.startswith("Linker script and memory map")
+                continue
+
+            secao = SECAO_SAIDA.match(linha)
+            if secao:
+                saida = secao.group(1)
+                pendente = None
+                continue
+
+            if pendente:
+                # Nome longo: endereço, tamanho e arquivo vêm na linha seguinte
+                continuacao = CONTINUACAO.match(linha)
+                if continuacao:
+                    somar(pendente, int(continuacao.group(2), 16), continuacao.group(3))
+                pendente = None
+                continue
+
+            entrada = SECAO_ENTRADA.match(linha)
+            if not entrada:
+                continue
+            if entrada.group(2) is None:
+                pendente = entrada.group(1)
+            else:
+                somar(entrada.group(1), int(entrada.group(3), 16), entrada.group(4))
+    return modulos
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mapa", help="mapa do linker (ex.: build/menu_funcoes.elf.map)")
+    parser.add_argument("--simbolo", action="append", default=[],
+                        help="atribui o símbolo a outro módulo (simbolo=modulo); padrão font=font.h")
+    parser.add_argument("--limite-ram", type=int, help="orçamento de RAM estática em bytes")
+    parser.add_argument("--limite-flash", type=int, help="orçamento de flash em bytes")
+    argumentos = parser.parse_args()
+
+    simbolos = dict(item.split("=", 1) for item in (argumentos.simbolo or ["font=font.h"]))
+    modulos = ler_mapa(argumentos.mapa, simbolos)
+
+    print("%-28s %9s %9s %9s" % ("modulo", "flash", "ram", "(bss)"))
+    total = collections.Counter()
+    for nome, uso in sorted(modulos.items(), key=lambda item: -(item[1]["flash"] + item[1]["data"] + item[1]["bss"])):
+        flash = uso["flash"] + uso["data"]
+        ram = uso["data"] + uso["bss"]
+        if flash == 0 and ram == 0:
+            continue
+        print("%-28s %9d %9d %9d" % (nome, flash, ram, uso["bss"]))
+        total["flash"] += flash
+        total["ram"] += ram
+    print("%-28s %9d %9d" % ("total", total["flash"], total["ram"]))
+    print("flash %.1f%% de %d KiB, ram estatica %.1f%% de %d KiB" % (
+        100.0 * total["flash"] / FLASH_TOTAL, FLASH_TOTAL // 1024,
+        100.0 * total["ram"] / RAM_TOTAL, RAM_TOTAL // 1024))
+
+    estouro = False
+    if argumentos.limite_ram is not None and total["ram"] > argumentos.limite_ram:
+        print("RAM estatica acima do orcamento: %d > %d" % (total["ram"], argumentos.limite_ram))
+        estouro = True
+    if argumentos.limite_flash is not None and total["flash"] > argumentos.limite_flash:
+        print("flash acima do orcamento: %d > %d" % (total["flash"], argumentos.limite_flash))
+        estouro = True
+    sys.exit(1 if estouro else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Simboliza o histograma do perfilador por amostragem (comando 'perfil').
+
+Lê o despejo do dispositivo (pela porta USB ou de um arquivo salvo) e agrupa
+as amostras de PC por função usando a tabela de símbolos do menu_funcoes.elf.
+As amostras de LR indicam quem chamou as funções folha (ex.: rotinas de ponto
+flutuante em software chamadas por sin/cos).
+
+O firmware precisa ser compilado com -DPERFILADOR=ON.
+
+Exemplos:
+    ./perfil_simbolos.py --elf build/menu_funcoes.elf --porta /dev/ttyACM0 --segundos 10
+    ./perfil_simbolos.py --elf build/menu_funcoes.elf --arquivo despejo.txt --linhas 10
+"""
+
+import argparse
+import bisect
+import collections
+import os
+import subprocess
+import termios
+import time
+import tty
+
+
+class Porta:
+    def __init__(self, caminho):
+        self.descritor = os.open(caminho, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.descritor)
+        termios.tcflush(self.descritor, termios.TCIOFLUSH)
+        self.pendente = b""
+
+    def comando(self, texto, tempo_limite=10.0):
+        """Envia o comando e devolve as linhas recebidas até a resposta ok/erro."""
+        os.write(self.descritor, (texto + "\n").encode())
+        linhas = []
+        limite = time.monotonic() + tempo_limite
+        while time.monotonic() < limite:
+            while b"\n" in self.pendente:
+                linha, self.pendente = self.pendente.split(b"\n", 1)
+                linha = linha.strip().decode(errors="ignore")
+                linhas.append(linha)
+                if linha.startswith("ok") or linha.startswith("erro"):
+                    return linhas
+            self.pendente += os.read(self.descritor, 4096)
+        raise TimeoutError("sem resposta para '%s'" % texto)
+
+
+class Simbolos:
+    def __init__(self, elf, nm):
+        saida = subprocess.run([nm, "-n", "-S", "-C", elf], check=True,
+                               capture_output=True, text=True).stdout
+        self.inicios = []
+        self.entradas = []
+        for linha in saida.splitlines():
+            partes = linha.split(None, 3)
+            if len(partes) < 4 or partes[2] not in "tTwW":
+                continue
+            inicio, tamanho = int(partes[0], 16), int(partes[1], 16)
+            self.inicios.append(inicio)
+            self.entradas.append((inicio, tamanho, partes[3]))
+
+    def nome(self, endereco):
+        i = bisect.bisect_right(self.inicios, endereco) - 1
+        if i < 0:
+            return "?"
+        inicio, tamanho, nome = self.entradas[i]
+        if tamanho and endereco >= inicio + tamanho:
+            return "? (0x%08x)" % endereco
+        return nome
+
+
+def ler_despejo(linhas):
+    cabecalho = {}
+    pcs, lrs = collections.Counter(), collections.Counter()
+    for linha in linhas:
+        partes = linha.split()
+        if not partes:
+            continue
+        if partes[0] == "perfil":
+            cabecalho = dict(item.split("=", 1) for item in partes[1:] if "=" in item)
+        elif partes[0] in ("pc", "lr") and len(partes) == 3:
+            destino = pcs if partes[0] == "pc" else lrs
+            destino[int(partes[1], 16)] += int(partes[2])
+    return cabecalho, pcs, lrs
+
+
+def imprimir_tabela(titulo, contagens, simbolos, limite):
+    por_funcao = collections.Counter()
+    for endereco, contagem in contagens.items():
+        por_funcao[simbolos.nome(endereco)] += contagem
+    total = sum(por_funcao.values()) or 1
+    print("\n%s (%d amostras)" % (titulo, total))
+    print("%7s %8s  %s" % ("%", "amostras", "funcao"))
+    for nome, contagem in por_funcao.most_common(limite):
+        print("%6.2f%% %8d  %s" % (100.0 * contagem / total, contagem, nome))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--elf", default="build/menu_funcoes.elf", help="firmware com símbolos")
+    origem = parser.add_mutually_exclusive_group(required=True)
+    origem.add_argument("--porta", help="porta serial USB (ex.: /dev/ttyACM0)")
+    origem.add_argument("--arquivo", help="despejo salvo anteriormente")
+    parser.add_argument("--segundos", type=float, default=5.0, help="duração da amostragem (com --porta)")
+    parser.add_argument("--hz", type=int, default=0, help="frequência de amostragem (0 = padrão do firmware)")
+    parser.add_argument("--salvar", help="grava o despejo recebido neste arquivo")
+    parser.add_argument("--top", type=int, default=25, help="funções listadas em cada tabela")
+    parser.add_argument("--linhas", type=int, default=0, help="mostra arquivo:linha dos N PCs mais frequentes")
+    parser.add_argument("--prefixo", default="arm-none-eabi-", help="prefixo das binutils")
+    argumentos = parser.parse_args()
+
+    if argumentos.porta:
+        porta = Porta(argumentos.porta)
+        resposta = porta.comando("perfil iniciar" + (" %d" % argumentos.hz if argumentos.hz else ""))
+        if not resposta[-1].startswith("ok"):
+            raise SystemExit(resposta[-1])
+        time.sleep(argumentos.segundos)
+        linhas = porta.comando("perfil despejar")
+        porta.comando("perfil parar")
+        if argumentos.salvar:
+            with open(argumentos.salvar, "w") as arquivo:
+                arquivo.write("\n".join(linhas) + "\n")
+    else:
+        with open(argumentos.arquivo) as arquivo:
+            linhas = arquivo.read().splitlines()
+
+    cabecalho, pcs, lrs = ler_despejo(linhas)
+    print("amostras=%s perdidas=%s hz=%s" % (cabecalho.get("amostras", "?"),
+                                             cabecalho.get("perdidas", "?"), cabecalho.get("hz", "?")))
+
+    simbolos = Simbolos(argumentos.elf, argumentos.prefixo + "nm")
+    imprimir_tabela("Funcoes interrompidas (PC)", pcs, simbolos, argumentos.top)
+    imprimir_tabela("Chamadores (LR)", lrs, simbolos, argumentos.top)
+
+    if argumentos.linhas:
+        enderecos = [endereco for endereco, _ in pcs.most_common(argumentos.linhas)]
+        saida = subprocess.run([argumentos.prefixo + "addr2line", "-f", "-C", "-e", argumentos.elf] +
+                               ["0x%x" % endereco for endereco in enderecos],
+                               check=True, capture_output=True, text=True).stdout.splitlines()
+        print("\nPCs mais frequentes")
+        for i, endereco in enumerate(enderecos):
+            print("%8d  0x%08x  %s  %s" % (pcs[endereco], endereco, saida[2 * i], saida[2 * i + 1]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Converte o rastro de eventos do dispositivo para o formato Chrome Trace.
+
+Pede o despejo pela porta USB (comando 'rastro despejar') ou lê um quadro
+QUADRO_RASTRO de uma captura binária. O JSON gerado abre em
+chrome://tracing ou em https://ui.perfetto.dev.
+
+Exemplos:
+    ./rastro_chrome.py --porta /dev/ttyACM0 --saida rastro.json
+    ./rastro_chrome.py --arquivo sessao.bin --saida rastro.json
+"""
+
+import argparse
+import json
+import os
+import struct
+import termios
+import time
+import tty
+
+from visualizador_tela import LeitorQuadros
+
+QUADRO_RASTRO = 0x04
+
+RASTRO_ESTADO = 1
+RASTRO_GPIO_ENTRADA = 2
+RASTRO_GPIO_SAIDA = 3
+RASTRO_RENDER_INICIO = 4
+RASTRO_RENDER_FIM = 5
+RASTRO_ENVIO_INICIO = 6
+RASTRO_ENVIO_FIM = 7
+RASTRO_ADC = 8
+
+ESTADOS = {0: "menu", 1: "configurar", 2: "grafico", 3: "valores"}
+FUNCOES = {0: "afim", 1: "quadratica", 2: "senoidal", 3: "cossenoidal"}
+
+LINHA_PRINCIPAL = 1
+LINHA_INTERRUPCOES = 2
+
+
+def ler_da_porta(caminho, tempo_limite=5.0):
+    descritor = os.open(caminho, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(descritor)
+    termios.tcflush(descritor, termios.TCIOFLUSH)
+    os.write(descritor, b"rastro despejar\n")
+    leitor = LeitorQuadros()
+    limite = time.monotonic() + tempo_limite
+    while time.monotonic() < limite:
+        for tipo, _, dados in leitor.alimentar(os.read(descritor, 16384)):
+            if tipo == QUADRO_RASTRO:
+                return dados
+    raise TimeoutError("nenhum quadro de rastro recebido")
+
+
+def ler_do_arquivo(caminho):
+    leitor = LeitorQuadros()
+    ultimo = None
+    with open(caminho, "rb") as arquivo:
+        for tipo, _, dados in leitor.alimentar(arquivo.read()):
+            if tipo == QUADRO_RASTRO:
+                ultimo = dados
+    if ultimo is None:
+        raise SystemExit("nenhum quadro de rastro em %s" % caminho)
+    return ultimo
+
+
+def decodificar(dados):
+    total, quantidade = struct.unpack_from("<IH", dados, 0)
+    eventos = [struct.unpack_from("<IBBH", dados, 6 + 8 * i) for i in range(quantidade)]
+    return total, eventos
+
+
+def converter(eventos):
+    saida = [
+        {"ph": "M", "pid": 0, "tid": LINHA_PRINCIPAL, "name": "thread_name", "args": {"name": "laco principal"}},
+        {"ph": "M", "pid": 0, "tid": LINHA_INTERRUPCOES, "name": "thread_name", "args": {"name": "IRQ GPIO"}},
+    ]
+    base = 0
+    anterior = None
+    for instante, tipo, argumento, valor in eventos:
+        # time_us_32 volta a zero a cada ~71 minutos
+        if anterior is not None and instante < anterior:
+            base += 1 << 32
+        anterior = instante
+        ts = base + instante
+        evento = {"pid": 0, "tid": LINHA_PRINCIPAL, "ts": ts}
+
+        if tipo == RASTRO_ESTADO:
+            evento.update(ph="i", s="g", name="estado " + ESTADOS.get(argumento, str(argumento)))
+        elif tipo in (RASTRO_GPIO_ENTRADA, RASTRO_GPIO_SAIDA):
+            evento.update(ph="B" if tipo == RASTRO_GPIO_ENTRADA else "E", tid=LINHA_INTERRUPCOES,
+                          name="gpio %d" % argumento)
+            if tipo == RASTRO_GPIO_ENTRADA:
+                evento["args"] = {"bordas": valor}
+        elif tipo in (RASTRO_RENDER_INICIO, RASTRO_RENDER_FIM):
+            evento.update(ph="B" if tipo == RASTRO_RENDER_INICIO else "E",
+                          name="render " + ESTADOS.get(argumento, str(argumento)),
+                          args={"funcao": FUNCOES.get(valor, valor)})
+        elif tipo in (RASTRO_ENVIO_INICIO, RASTRO_ENVIO_FIM):
+            evento.update(ph="B" if tipo == RASTRO_ENVIO_INICIO else "E", name="envio i2c")
+            if tipo == RASTRO_ENVIO_FIM:
+                evento["args"] = {"bytes": valor, "subquadro": argumento}
+        elif tipo == RASTRO_ADC:
+            evento.update(ph="C", name="adc%d" % argumento, args={"leitura": valor})
+        else:
+            continue
+        saida.append(evento)
+    return saida
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    origem = parser.add_mutually_exclusive_group(required=True)
+    origem.add_argument("--porta", help="porta serial USB (ex.: /dev/ttyACM0)")
+    origem.add_argument("--arquivo", help="captura binária (ex.: gravada pelo visualizador_tela.py)")
+    parser.add_argument("--saida", default="rastro.json", help="arquivo JSON de saída")
+    argumentos = parser.parse_args()
+
+    dados = ler_da_porta(argumentos.porta) if argumentos.porta else ler_do_arquivo(argumentos.arquivo)
+    total, eventos = decodificar(dados)
+    with open(argumentos.saida, "w") as saida:
+        json.dump({"traceEvents": converter(eventos), "displayTimeUnit": "ms"}, saida)
+    print("%d eventos exportados (%d registrados desde o boot) em %s" % (len(eventos), total, argumentos.saida))
+
+
+if __name__ == "__main__":
+    main()
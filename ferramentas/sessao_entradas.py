@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Grava e reproduz sessões de entradas (botões, joystick e ADC) no dispositivo.
+
+'gravar' liga a gravação, espera o uso manual e salva o despejo em um arquivo
+de texto. 'reproduzir' carrega o arquivo no dispositivo, reproduz a sessão e
+informa quadros, tempo de desenho e bytes I2C; com --csv acrescenta o
+resultado a uma planilha para comparar versões do firmware.
+
+O estado inicial vem em duas linhas: "sessao inicio" (tela, função,
+parâmetros, zoom e centro x), "sessao vista" (centro e escala de y, cursor,
+análise e passo da tabela) e "sessao captura" (canal, taxa e gatilho do
+osciloscópio). Arquivos antigos sem as duas últimas são reproduzidos com a
+vista e a captura padrão.
+
+Exemplos:
+    ./sessao_entradas.py gravar --porta /dev/ttyACM0 --arquivo sessao.txt --segundos 30
+    ./sessao_entradas.py reproduzir --porta /dev/ttyACM0 --arquivo sessao.txt --csv resultados.csv --rotulo v2
+"""
+
+import argparse
+import os
+import termios
+import time
+import tty
+
+
+class Porta:
+    def __init__(self, caminho):
+        self.descritor = os.open(caminho, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.descritor)
+        termios.tcflush(self.descritor, termios.TCIOFLUSH)
+        self.pendente = b""
+
+    def linha(self, limite):
+        while time.monotonic() < limite:
+            if b"\n" in self.pendente:
+                linha, self.pendente = self.pendente.split(b"\n", 1)
+                return linha.strip().decode(errors="ignore")
+            self.pendente += os.read(self.descritor, 4096)
+        raise TimeoutError("sem resposta do dispositivo")
+
+    def comando(self, texto, tempo_limite=5.0):
+        """Envia o comando e devolve as linhas recebidas até a resposta ok/erro."""
+        os.write(self.descritor, (texto + "\n").encode())
+        linhas = []
+        limite = time.monotonic() + tempo_limite
+        while True:
+            linha = self.linha(limite)
+            linhas.append(linha)
+            if linha.startswith("ok") or linha.startswith("erro"):
+                return linhas
+
+    def aguardar(self, prefixo, tempo_limite):
+        limite = time.monotonic() + tempo_limite
+        while True:
+            linha = self.linha(limite)
+            if linha.startswith(prefixo):
+                return linha
+
+
+CAMPOS_INICIO = ["estado", "funcao", "indice", "a", "b", "c", "d", "zoom", "centro"]
+CAMPOS_VISTA = ["centro_y", "escala_y", "cursor", "coluna", "analise", "x0", "x1", "passo_tabela"]
+CAMPOS_CAPTURA = ["osc_canal", "osc_taxa", "osc_borda", "osc_nivel"]
+
+
+def ler_estado_inicial(linhas):
+    """Campos das linhas de estado inicial ({} se faltarem)."""
+    estado = {}
+    for linha in linhas:
+        partes = linha.split()
+        for tipo, campos in (("inicio", CAMPOS_INICIO), ("vista", CAMPOS_VISTA), ("captura", CAMPOS_CAPTURA)):
+            if partes[1] == tipo:
+                if len(partes) - 2 != len(campos):
+                    raise SystemExit("linha '%s' com %d campos, esperados %d" % (linha, len(partes) - 2, len(campos)))
+                estado.update(zip(campos, partes[2:]))
+    return estado
+
+
+def descrever_estado(estado):
+    return " ".join("%s=%s" % (campo, estado[campo]) for campo in CAMPOS_INICIO + CAMPOS_VISTA + CAMPOS_CAPTURA
+                    if campo in estado)
+
+
+def gravar(porta, argumentos):
+    porta.comando("sessao gravar")
+    if argumentos.segundos:
+        print("Gravando por %.0f s..." % argumentos.segundos)
+        time.sleep(argumentos.segundos)
+    else:
+        input("Gravando; use os botoes e o joystick e tecle Enter para parar. ")
+    porta.comando("sessao parar")
+    linhas = [linha for linha in porta.comando("sessao despejar", 30.0) if linha.startswith("sessao ")]
+    with open(argumentos.arquivo, "w") as arquivo:
+        arquivo.write("\n".join(linhas) + "\n")
+    entradas = sum(1 for linha in linhas if linha.startswith("sessao entrada"))
+    print("%d entradas salvas em %s" % (entradas, argumentos.arquivo))
+    print("inicio: %s" % descrever_estado(ler_estado_inicial(linhas)))
+
+
+def reproduzir(porta, argumentos):
+    with open(argumentos.arquivo) as arquivo:
+        linhas = [linha.strip() for linha in arquivo if linha.startswith("sessao ")]
+    estado = ler_estado_inicial(linhas)
+    if "estado" not in estado:
+        raise SystemExit("%s sem a linha 'sessao inicio'" % argumentos.arquivo)
+    if "escala_y" not in estado:
+        print("aviso: arquivo sem 'sessao vista'; reproduzindo com a vista padrao")
+    if "osc_canal" not in estado:
+        print("aviso: arquivo sem 'sessao captura'; reproduzindo com a captura padrao")
+    print("inicio: %s" % descrever_estado(estado))
+    duracao_s = 0.0
+    porta.comando("sessao carregar")
+    for linha in linhas:
+        resposta = porta.comando(linha)[-1]
+        if not resposta.startswith("ok"):
+            raise SystemExit("%s -> %s" % (linha, resposta))
+        if linha.startswith("sessao duracao"):
+            duracao_s = int(linha.split()[2]) / 1e6
+
+    porta.comando("sessao reproduzir")
+    resultado = porta.aguardar("reproducao fim", duracao_s + 30.0)
+    campos = dict(item.split("=", 1) for item in resultado.split()[2:])
+    print(resultado)
+
+    if argumentos.csv:
+        novo = not os.path.exists(argumentos.csv)
+        with open(argumentos.csv, "a") as saida:
+            chaves = sorted(campos)
+            if novo:
+                saida.write("rotulo,%s\n" % ",".join(chaves))
+            saida.write("%s,%s\n" % (argumentos.rotulo, ",".join(campos[chave] for chave in chaves)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("acao", choices=["gravar", "reproduzir"])
+    parser.add_argument("--porta", required=True, help="porta serial USB (ex.: /dev/ttyACM0)")
+    parser.add_argument("--arquivo", required=True, help="arquivo da sessão")
+    parser.add_argument("--segundos", type=float, default=0, help="duração da gravação (0 = até Enter)")
+    parser.add_argument("--csv", help="acrescenta o resultado da reprodução a este CSV")
+    parser.add_argument("--rotulo", default=time.strftime("%Y-%m-%d %H:%M"), help="identificação da linha no CSV")
+    argumentos = parser.parse_args()
+
+    porta = Porta(argumentos.porta)
+    if argumentos.acao == "gravar":
+        gravar(porta, argumentos)
+    else:
+        reproduzir(porta, argumentos)
+
+
+if __name__ == "__main__":
+    main()
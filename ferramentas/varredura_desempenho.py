@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Varredura automática de desempenho pela interface de comandos USB.
+
+Percorre combinações de função, parâmetros e zoom, pede renderizações ao
+dispositivo e grava tempo e bytes I2C de cada uma em CSV.
+
+Exemplo:
+    ./varredura_desempenho.py --porta /dev/ttyACM0 --saida desempenho.csv --repeticoes 5
+"""
+
+import argparse
+import itertools
+import os
+import termios
+import time
+import tty
+
+FUNCOES = {0: "afim", 1: "quadratica", 2: "senoidal", 3: "cossenoidal", 4: "parametrica", 5: "polar"}
+ZOOMS = [0.5, 1.0, 2.0, 5.0, 10.0]
+PARAMETROS = {
+    0: [(1, 0, 0, 0), (5, -10, 0, 0), (-0.5, 20, 0, 0)],
+    1: [(1, 0, 0, 0), (0.5, -2, -10, 0), (-2, 5, 40, 0)],
+    2: [(0, 10, 1, 0), (5, 25, 2, 1.5), (0, 5, 10, 0)],
+    3: [(0, 10, 1, 0), (5, 25, 2, 1.5), (0, 5, 10, 0)],
+    4: [(20, 20, 1, 1.5708), (50, 28, 3, 0), (60, 30, 5, 0.5)],
+    5: [(20, 0, 1, 0), (0, 28, 5, 0), (15, 15, 1, 0)],
+}
+
+
+class Porta:
+    def __init__(self, caminho):
+        self.descritor = os.open(caminho, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.descritor)
+        termios.tcflush(self.descritor, termios.TCIOFLUSH)
+        self.pendente = b""
+
+    def comando(self, texto, tempo_limite=5.0):
+        os.write(self.descritor, (texto + "\n").encode())
+        limite = time.monotonic() + tempo_limite
+        while time.monotonic() < limite:
+            while b"\n" in self.pendente:
+                linha, self.pendente = self.pendente.split(b"\n", 1)
+                linha = linha.strip().decode(errors="ignore")
+                if linha.startswith("ok") or linha.startswith("erro"):
+                    return linha
+            self.pendente += os.read(self.descritor, 4096)
+        raise TimeoutError("sem resposta para '%s'" % texto)
+
+
+def campos(resposta):
+    return dict(item.split("=", 1) for item in resposta.split()[2:] if "=" in item)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--porta", required=True, help="porta serial USB (ex.: /dev/ttyACM0)")
+    parser.add_argument("--saida", default="desempenho.csv", help="arquivo CSV de saída")
+    parser.add_argument("--repeticoes", type=int, default=3, help="renderizações por configuração")
+    argumentos = parser.parse_args()
+
+    porta = Porta(argumentos.porta)
+    with open(argumentos.saida, "w") as saida:
+        saida.write("funcao,a,b,c,d,zoom,us_min,us_medio,us_max,i2c_bytes,i2c_transacoes\n")
+        for funcao, nome in FUNCOES.items():
+            porta.comando("funcao %d" % funcao)
+            for parametros, zoom in itertools.product(PARAMETROS[funcao], ZOOMS):
+                porta.comando("params %s" % " ".join(str(p) for p in parametros))
+                porta.comando("zoom %s" % zoom)
+                resposta = porta.comando("render %d" % argumentos.repeticoes)
+                if not resposta.startswith("ok"):
+                    print(resposta)
+                    continue
+                valores = campos(resposta)
+                saida.write("%s,%s,%s,%s,%s,%s,%s\n" % (
+                    nome, ",".join(str(p) for p in parametros), zoom, valores["us_min"],
+                    valores["us_medio"], valores["us_max"], valores["i2c_bytes"], valores["i2c_transacoes"]))
+                print(nome, parametros, zoom, valores["us_medio"], "us")
+    porta.comando("menu")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""Visualizador e gravador do framebuffer transmitido pela USB.
+
+Lê os quadros binários enviados por transmissao_usb.c a partir da porta
+serial (CDC) ou de um arquivo de captura gravado anteriormente.
+
+Exemplos:
+    ./visualizador_tela.py --porta /dev/ttyACM0 --gravar sessao.bin
+    ./visualizador_tela.py --arquivo sessao.bin --pbm quadros/
+    ./visualizador_tela.py --arquivo sessao.bin --sem-tela
+"""
+
+import argparse
+import os
+import struct
+import sys
+import termios
+import tty
+
+LARGURA = 128
+ALTURA = 64
+TELA_BYTES = LARGURA * ALTURA // 8
+
+SINCRONISMO = b"\xA5\x5A"
+QUADRO_TELA_COMPLETA = 0x01
+QUADRO_TELA_DELTA = 0x02
+QUADRO_AMOSTRAS = 0x03
+DELTA_RLE = 0x80
+
+
+def fletcher16(dados):
+    soma1 = soma2 = 0
+    for byte in dados:
+        soma1 = (soma1 + byte) % 255
+        soma2 = (soma2 + soma1) % 255
+    return soma1, soma2
+
+
+class LeitorQuadros:
+    """Separa o fluxo de bytes em quadros válidos, ignorando texto do printf."""
+
+    def __init__(self):
+        self.pendente = bytearray()
+        self.erros = 0
+
+    def alimentar(self, dados):
+        self.pendente.extend(dados)
+        while True:
+            inicio = self.pendente.find(SINCRONISMO)
+            if inicio < 0:
+                # Mantém o último byte caso seja metade do sincronismo
+                del self.pendente[:-1]
+                return
+            del self.pendente[:inicio]
+            if len(self.pendente) < 6:
+                return
+            tipo, sequencia, comprimento = struct.unpack_from("<BBH", self.pendente, 2)
+            total = 6 + comprimento + 2
+            if len(self.pendente) < total:
+                return
+            corpo = bytes(self.pendente[2:6 + comprimento])
+            if fletcher16(corpo) != tuple(self.pendente[6 + comprimento:total]):
+                # Sincronismo falso ou quadro corrompido: tenta a partir do próximo byte
+                self.erros += 1
+                del self.pendente[:1]
+                continue
+            del self.pendente[:total]
+            yield tipo, sequencia, corpo[4:]
+
+
+class Tela:
+    def __init__(self):
+        self.buffer = bytearray(TELA_BYTES)
+        self.sincronizada = False
+
+    def aplicar(self, tipo, dados):
+        if tipo == QUADRO_TELA_COMPLETA:
+            self.buffer[:] = dados
+            self.sincronizada = True
+        elif tipo == QUADRO_TELA_DELTA and self.sincronizada:
+            i = 0
+            while i < len(dados):
+                deslocamento, controle = struct.unpack_from("<HB", dados, i)
+                i += 3
+                quantidade = (controle & 0x7F) + 1
+                if controle & DELTA_RLE:
+                    self.buffer[deslocamento:deslocamento + quantidade] = bytes([dados[i]]) * quantidade
+                    i += 1
+                else:
+                    self.buffer[deslocamento:deslocamento + quantidade] = dados[i:i + quantidade]
+                    i += quantidade
+
+    def pixel(self, x, y):
+        return (self.buffer[(y // 8) * LARGURA + x] >> (y % 8)) & 1
+
+    def para_texto(self):
+        blocos = {(0, 0): " ", (1, 0): "▀", (0, 1): "▄", (1, 1): "█"}
+        linhas = []
+        for y in range(0, ALTURA, 2):
+            linhas.append("".join(blocos[(self.pixel(x, y), self.pixel(x, y + 1))] for x in range(LARGURA)))
+        return "\n".join(linhas)
+
+    def salvar_pbm(self, caminho):
+        linhas = bytearray()
+        for y in range(ALTURA):
+            for x0 in range(0, LARGURA, 8):
+                byte = 0
+                for b in range(8):
+                    byte = (byte << 1) | self.pixel(x0 + b, y)
+                linhas.append(byte)
+        with open(caminho, "wb") as arquivo:
+            arquivo.write(b"P4\n%d %d\n" % (LARGURA, ALTURA))
+            arquivo.write(linhas)
+
+
+def decodificar_amostras(dados):
+    quantidade, x_inicial, passo_x = struct.unpack_from("<Hff", dados, 0)
+    valores = struct.unpack_from("<%df" % quantidade, dados, 10)
+    return [(x_inicial + i * passo_x, y) for i, y in enumerate(valores)]
+
+
+def abrir_porta(caminho):
+    descritor = os.open(caminho, os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(descritor)
+    atributos = termios.tcgetattr(descritor)
+    atributos[3] &= ~termios.ECHO
+    termios.tcsetattr(descritor, termios.TCSANOW, atributos)
+    return descritor
+
+
+def blocos_entrada(argumentos):
+    if argumentos.arquivo:
+        with open(argumentos.arquivo, "rb") as arquivo:
+            while True:
+                bloco = arquivo.read(4096)
+                if not bloco:
+                    return
+                yield bloco
+    else:
+        descritor = abrir_porta(argumentos.porta)
+        try:
+            while True:
+                yield os.read(descritor, 4096)
+        finally:
+            os.close(descritor)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    origem = parser.add_mutually_exclusive_group(required=True)
+    origem.add_argument("--porta", help="porta serial USB (ex.: /dev/ttyACM0)")
+    origem.add_argument("--arquivo", help="captura gravada anteriormente")
+    parser.add_argument("--gravar", help="grava os bytes recebidos da porta neste arquivo")
+    parser.add_argument("--pbm", help="salva cada quadro como PBM neste diretório")
+    parser.add_argument("--amostras", help="acrescenta as amostras recebidas (x, y) neste CSV")
+    parser.add_argument("--sem-tela", action="store_true", help="não desenha no terminal")
+    argumentos = parser.parse_args()
+
+    leitor = LeitorQuadros()
+    tela = Tela()
+    contagem = {QUADRO_TELA_COMPLETA: 0, QUADRO_TELA_DELTA: 0, QUADRO_AMOSTRAS: 0}
+    gravacao = open(argumentos.gravar, "wb") if argumentos.gravar else None
+    csv = open(argumentos.amostras, "a") if argumentos.amostras else None
+    if argumentos.pbm:
+        os.makedirs(argumentos.pbm, exist_ok=True)
+
+    numero_quadro = 0
+    try:
+        for bloco in blocos_entrada(argumentos):
+            if gravacao:
+                gravacao.write(bloco)
+            for tipo, sequencia, dados in leitor.alimentar(bloco):
+                contagem[tipo] = contagem.get(tipo, 0) + 1
+                if tipo == QUADRO_AMOSTRAS:
+                    if csv:
+                        for x, y in decodificar_amostras(dados):
+                            csv.write("%d,%f,%f\n" % (sequencia, x, y))
+                    continue
+                tela.aplicar(tipo, dados)
+                if not tela.sincronizada:
+                    continue
+                numero_quadro += 1
+                if argumentos.pbm:
+                    tela.salvar_pbm(os.path.join(argumentos.pbm, "quadro_%06d.pbm" % numero_quadro))
+                if not argumentos.sem_tela:
+                    sys.stdout.write("\x1b[H" + tela.para_texto() + "\n")
+                    sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if gravacao:
+            gravacao.close()
+        if csv:
+            csv.close()
+
+    print("completos: %d  delta: %d  amostras: %d  erros: %d" % (
+        contagem[QUADRO_TELA_COMPLETA], contagem[QUADRO_TELA_DELTA], contagem[QUADRO_AMOSTRAS], leitor.erros))
+
+
+if __name__ == "__main__":
+    main()
@@ -5,11 +5,17 @@
 #include <math.h>
 #include "hardware/adc.h"
 #include "Matriz_Bibliotecas/matriz_led.h" // Inclua este cabeçalho
-
-// Definições dos pinos RGB
-#define PINO_RGB_VERMELHO 13
-#define PINO_RGB_VERDE 11
-#define PINO_RGB_AZUL 12
+#include "Display_Bibliotecas/camadas.h"
+#include "Display_Bibliotecas/texto.h"
+#include "transmissao_usb.h"
+#include "escala_cinza.h"
+#include "rastro.h"
+#include "sessao.h"
+#include "cache_amostras.h"
+#include "curvas.h"
+#include "partida.h"
+#include "led_rgb.h"
+#include "osciloscopio.h"
 
 // Variável global (Sistema)
 Sistema sistema;
@@ -19,28 +25,279 @@ Sistema sistema;
 #define PINO_BOTAO_JOYSTICK 22
 #define PINO_BOTAO_A 5
 #define PINO_BOTAO_B 6
-#define ATRASO_DEBOUNCE_MS 300
 #define ZONA_MORTA 300
+#define CANAL_JOYSTICK (PINO_JOYSTICK_Y - 26)
+
+// Barramento do display: o modo em tons de cinza precisa de envios mais rápidos
+#define I2C_FREQUENCIA_HZ 400000
+#define I2C_FREQUENCIA_CINZA_HZ 1000000
+
+// Segundo display (painel de dados) no i2c0
+#define PINO_SDA_PAINEL 8
+#define PINO_SCL_PAINEL 9
+
+// Animação de parâmetros
+#define ANIMACAO_FPS 30
+#define ANIMACAO_AMPLITUDE 5.0f      // Varredura de ±5 em torno do valor original
+#define ANIMACAO_DURACAO_MS 2000     // Tempo para percorrer a faixa uma vez
+#define ANIMACAO_RELATORIO_MS 2000   // Intervalo entre relatórios na serial
+
+// Efeitos do LED RGB
+#define LED_TRANSICAO_MS 150         // Troca de cor ou brilho
+#define LED_RESPIRACAO_MS 2000       // Período da respiração durante a animação
+#define INTERVALO_ZOOM_MS 200
+#define INTERVALO_MENU_MS 200        // Repetição da troca de função com o joystick parado fora do centro
+
+// Geometria da área do gráfico
+#define CENTRO_X (SSD1306_LARGURA / 2)  // Centro do display no eixo X
+#define CENTRO_Y (SSD1306_ALTURA / 2)   // Centro do display no eixo Y
+
+// Ajuste automático: a curva ocupa as linhas acima do HUD
+#define AJUSTE_LINHA_TOPO 2
+#define AJUSTE_LINHA_BASE 52
+#define AJUSTE_FATOR_MINIMO 0.001f
+#define AJUSTE_FATOR_MAXIMO 1000.0f
+
+// Cursor de leitura: a linha cobre as páginas 0 a 5 e a leitura as páginas 6 e 7
+#define CURSOR_PAGINAS 6
+#define CURSOR_LINHAS (CURSOR_PAGINAS * 8)
+#define LEITURA_PAGINA CURSOR_PAGINAS
+#define CURSOR_LIMIAR_RAPIDO 1500    // Desvio do joystick para andar CURSOR_PASSO_RAPIDO colunas
+#define CURSOR_PASSO_RAPIDO 4
+
+// Tabela de valores: uma linha por página, rolagem pela linha inicial do painel
+#define TABELA_LINHAS 8
+#define TABELA_COLUNA_Y 56            // Coluna onde começa f(x)
+#define TABELA_LIMIAR_RAPIDO 1500     // Desvio do joystick para rolar TABELA_ROLAGEM_RAPIDA linhas
+#define TABELA_ROLAGEM_RAPIDA 4
+
+static const float passos_tabela[TABELA_TOTAL_PASSOS] = {0.01f, 0.05f, 0.1f, 0.25f, 0.5f, 1, 2, 5, 10};
+
+// Espaçamento mínimo entre marcadores dos eixos, em pixels
+#define MARCADOR_ESPACO_X 20
+#define MARCADOR_ESPACO_Y 12
+#define MARCADORES_MAXIMO 32
+#define MARCADOR_INDICE_MAXIMO 16777216.0f  // 2^24: acima disso k + 1 não é representável em float
+
+// Osciloscópio: zoom 1 mostra 8 ms na largura e 0 a 3,3 V na altura
+#define OSC_PIXELS_POR_MS 16.0f
+#define OSC_PIXELS_POR_VOLT 16.0f
+#define OSC_LINHA_ZERO_VOLT (SSD1306_ALTURA - 4)
+
+// Sobreposição de análise: traços de 4 colunas na derivada e hachura da área
+// em colunas alternadas
+#define ANALISE_TRACO 4
+// Avaliações extras para a parte da integral fora da tela (por lado); acima
+// disso o passo aumenta e o valor é marcado como aproximado
+#define ANALISE_AMOSTRAS_FORA 128
+
+// Camadas do gráfico: eixos/rótulos, curva, HUD e análise (a última só
+// entra na composição com a sobreposição ligada)
+static camada_t camada_eixos;
+static camada_t camada_curva;
+static camada_t camada_hud;
+static camada_t camada_analise;
+static camada_t *const camadas_grafico[] = {&camada_eixos, &camada_curva, &camada_hud, &camada_analise};
+
+// Nível de cinza (0 a 3) de cada camada: eixos esmaecidos sob a curva
+static const uint8_t niveis_grafico[] = {1, 3, 3, 2};
+
+// Transformação pixel <-> mundo e a vista que a originou; a geração muda a
+// cada recálculo e invalida a camada de eixos
+static TransformacaoVista vista;
+static bool vista_valida = false;
+static float vista_zoom, vista_fator_y, vista_centro_x, vista_centro_y;
+static uint32_t vista_geracao = 0;
+
+// Geração da vista usada na última montagem da camada de eixos; HUD pelo zoom
+static bool eixos_validos = false;
+static uint32_t eixos_geracao;
+static bool hud_valido = false;
+static float hud_zoom;
+
+// Cursor desenhado na tela (coluna e linha do marcador; -1 = sem marcador)
+static int16_t cursor_coluna_desenhada;
+static int16_t cursor_linha_desenhada = -1;
+static uint8_t leitura_largura;  // Colunas ocupadas pelo texto da última leitura
+
+// Quantidade de parâmetros usados por cada tipo de função
+static const uint8_t parametros_por_funcao[TOTAL_FUNCOES] = {2, 3, 4, 4, 4, 4};
+
+// Dois valores rotulados com duas casas na mesma linha, como "A:1.00 B:-2.50"
+static void formatar_par(char *buffer, const char *fim, const char *rotulo_1, float valor_1,
+                         const char *rotulo_2, float valor_2) {
+    char *texto = texto_anexar(buffer, fim, rotulo_1);
+    texto = texto_numero(texto, fim, valor_1, 2, 0);
+    texto = texto_anexar(texto, fim, " ");
+    texto = texto_anexar(texto, fim, rotulo_2);
+    texto_numero(texto, fim, valor_2, 2, 0);
+}
+
+// Instante em que começou o desenho da tela atual
+static uint32_t inicio_quadro_us;
+
+// Início do desenho de uma tela (rastro e tempo do quadro)
+static void iniciar_quadro(Sistema *sistema, EstadoSistema tela) {
+    rastro_registrar(RASTRO_RENDER_INICIO, tela, sistema->funcao_selecionada);
+    inicio_quadro_us = time_us_32();
+}
+
+#if SEGUNDA_TELA_ATIVA
+// Painel de dados no segundo display: função, parâmetros, vértice da
+// quadrática, zoom e integral da análise. Só é redesenhado e enviado quando
+// o conteúdo muda, e o envio por DMA no i2c0 corre em paralelo com o quadro
+// principal no i2c1.
+typedef struct {
+    TipoFuncao funcao;
+    float parametros[4];
+    float zoom;
+    bool analise;
+    float integral;
+    bool aproximada;
+} ConteudoPainel;
+
+static ConteudoPainel painel_exibido;
+static bool painel_valido = false;
+
+static const char *const nomes_painel[TOTAL_FUNCOES] = {
+    "AFIM", "QUADRATICA", "SENOIDAL", "COSSENO", "PARAMETRICA", "POLAR"
+};
+
+static void atualizar_painel_dados(Sistema *sistema) {
+    ConteudoPainel conteudo;
+    memset(&conteudo, 0, sizeof(conteudo));  // Sem lixo no preenchimento para o memcmp
+    conteudo.funcao = sistema->funcao_selecionada;
+    memcpy(conteudo.parametros, sistema->parametros, sizeof(conteudo.parametros));
+    conteudo.zoom = sistema->nivel_zoom;
+    conteudo.analise = sistema->analise.ativa && funcao_cartesiana(sistema->funcao_selecionada);
+    conteudo.integral = conteudo.analise ? sistema->analise.integral : 0.0f;
+    conteudo.aproximada = conteudo.analise && sistema->analise.aproximada;
+    if (painel_valido && memcmp(&conteudo, &painel_exibido, sizeof(conteudo)) == 0) {
+        return;
+    }
+
+    ssd1306_t *painel = &sistema->painel_dados;
+    ssd1306_fill(painel, false);
+    ssd1306_draw_string(painel, nomes_painel[conteudo.funcao], 0, 0, false);
+
+    char buffer[24];
+    const char *fim = buffer + sizeof(buffer);
+    const float *p = conteudo.parametros;
+    formatar_par(buffer, fim, "A:", p[0], "B:", p[1]);
+    ssd1306_draw_string(painel, buffer, 0, 12, true);
+    if (parametros_por_funcao[conteudo.funcao] > 2) {
+        formatar_par(buffer, fim, "C:", p[2], "D:", p[3]);
+        ssd1306_draw_string(painel, buffer, 0, 22, true);
+    }
+
+    // O que antes exigia a tela de valores fica sempre visível
+    if (conteudo.funcao == FUNCAO_QUADRATICA) {
+        float delta = p[1] * p[1] - 4 * p[0] * p[2];
+        formatar_par(buffer, fim, "Xv:", -p[1] / (2 * p[0]), "Yv:", -delta / (4 * p[0]));
+        ssd1306_draw_string(painel, buffer, 0, 32, true);
+        ssd1306_draw_string(painel, "Delta:", 0, 42, true);
+        texto_desenhar_numero(painel, delta, 2, 0, 48, 42, true);
+    }
+
+    if (conteudo.analise) {
+        char *texto = texto_anexar(buffer, fim, "Z:");
+        texto = texto_numero(texto, fim, conteudo.zoom, 1, 0);
+        texto = texto_anexar(texto, fim, conteudo.aproximada ? " S~" : " S:");
+        texto_numero(texto, fim, conteudo.integral, 3, 0);
+        ssd1306_draw_string(painel, buffer, 0, 55, true);
+    } else {
+        ssd1306_draw_string(painel, "Zoom: ", 0, 55, true);
+        uint8_t x = texto_desenhar_numero(painel, conteudo.zoom, 1, 0, 48, 55, true);
+        ssd1306_draw_char(painel, 'x', x, 55, true);
+    }
+
+    ssd1306_send_data_dma(painel);
+    painel_exibido = conteudo;
+    painel_valido = true;
+}
+#endif
+
+// Envia o framebuffer ao display e, se habilitado, também pela USB
+static void enviar_tela(Sistema *sistema) {
+#if SEGUNDA_TELA_ATIVA
+    atualizar_painel_dados(sistema);
+#endif
+    uint32_t bytes_antes = sistema->tela.bytes_enviados;
+    rastro_registrar(RASTRO_ENVIO_INICIO, 0, 0);
+    led_rgb_sinalizar_envio(true);
+    ssd1306_send_data(&sistema->tela);
+    led_rgb_sinalizar_envio(false);
+    rastro_registrar(RASTRO_ENVIO_FIM, 0, sistema->tela.bytes_enviados - bytes_antes);
+    transmissao_enviar_tela(&sistema->tela);
+    sessao_contar_quadro(time_us_32() - inicio_quadro_us);
+}
+
+// Troca de estado registrada no rastro
+void definir_estado(Sistema *sistema, EstadoSistema estado) {
+    // Só a tabela desloca a linha inicial do painel
+    if (sistema->estado_atual == ESTADO_EXIBIR_TABELA && estado != ESTADO_EXIBIR_TABELA) {
+        ssd1306_definir_linha_inicial(&sistema->tela, 0);
+    }
+    // Fora do osciloscópio o ADC volta às leituras avulsas do joystick
+    if (sistema->estado_atual == ESTADO_OSCILOSCOPIO && estado != ESTADO_OSCILOSCOPIO) {
+        osciloscopio_parar();
+    }
+    sistema->estado_atual = estado;
+    rastro_registrar(RASTRO_ESTADO, estado, 0);
+}
 
 void inicializar_sistema(Sistema *sistema_ptr) {
     // Configuração I2C
-    i2c_init(i2c1, 400000);
+    i2c_init(i2c1, I2C_FREQUENCIA_HZ);
     gpio_set_function(14, GPIO_FUNC_I2C);
     gpio_set_function(15, GPIO_FUNC_I2C);
     gpio_pull_up(14);
     gpio_pull_up(15);
 
-    // Inicialização do display
+    // Inicialização do display: os comandos seguem por DMA enquanto o resto
+    // da partida acontece (ver exibir_primeiro_quadro)
     ssd1306_init(&sistema_ptr->tela, 128, 64, false, 0x3C, i2c1);
-    ssd1306_config(&sistema_ptr->tela);
-    ssd1306_fill(&sistema_ptr->tela, false);
-    ssd1306_send_data(&sistema_ptr->tela);
+    ssd1306_config_dma(&sistema_ptr->tela);
+
+#if SEGUNDA_TELA_ATIVA
+    // Painel de dados no outro controlador, configurado ao mesmo tempo
+    i2c_init(i2c0, I2C_FREQUENCIA_HZ);
+    gpio_set_function(PINO_SDA_PAINEL, GPIO_FUNC_I2C);
+    gpio_set_function(PINO_SCL_PAINEL, GPIO_FUNC_I2C);
+    gpio_pull_up(PINO_SDA_PAINEL);
+    gpio_pull_up(PINO_SCL_PAINEL);
+    ssd1306_init(&sistema_ptr->painel_dados, 128, 64, false, 0x3C, i2c0);
+    ssd1306_config_dma(&sistema_ptr->painel_dados);
+#endif
+
+    // Camadas do gráfico
+    camada_init(&camada_eixos);
+    camada_init(&camada_curva);
+    camada_init(&camada_hud);
+    camada_init(&camada_analise);
 
     // Inicialização da matriz de LED (aqui!)
     inicializar_matriz_led();
 }
 
+// Primeiro quadro da partida: o menu vai para a RAM do display assim que a
+// configuração termina e só então o painel é ligado, sem quadro em branco
+void exibir_primeiro_quadro(Sistema *sistema) {
+    ssd1306_aguardar_dma(&sistema->tela);
+#if SEGUNDA_TELA_ATIVA
+    ssd1306_aguardar_dma(&sistema->painel_dados);
+#endif
+    partida_marcar(PARTIDA_DISPLAY_CONFIGURADO);
+    desenhar_tela_menu(sistema);
+    ssd1306_command(&sistema->tela, 0xAF); // Display on
+#if SEGUNDA_TELA_ATIVA
+    ssd1306_command(&sistema->painel_dados, 0xAF);  // Espera o envio do painel terminar
+#endif
+    partida_marcar(PARTIDA_PRIMEIRO_QUADRO);
+}
+
 void desenhar_tela_menu(Sistema *sistema) {
+    iniciar_quadro(sistema, ESTADO_MENU);
     ssd1306_fill(&sistema->tela, false);
 
     const char *titulo = "SELECIONE:";
@@ -50,11 +307,13 @@ void desenhar_tela_menu(Sistema *sistema) {
         "1. AFIM",
         "2. QUADRATICA",
         "3. SENOIDAL",
-        "4. COSSENO"
+        "4. COSSENO",
+        "5. PARAMETRICA",
+        "6. POLAR"
     };
 
     for (int i = 0; i < TOTAL_FUNCOES; i++) {
-        uint8_t y = 16 + i * 12;
+        uint8_t y = 10 + i * 9;
         if (i == sistema->funcao_selecionada) {
             ssd1306_draw_string(&sistema->tela, ">", 4, y, false);
             ssd1306_draw_string(&sistema->tela, funcoes[i], 16, y, false);
@@ -62,38 +321,45 @@ void desenhar_tela_menu(Sistema *sistema) {
             ssd1306_draw_string(&sistema->tela, funcoes[i], 12, y, false);
         }
     }
-    ssd1306_send_data(&sistema->tela);
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_MENU, sistema->funcao_selecionada);
+    enviar_tela(sistema);
 }
 
 void desenhar_tela_configuracao_parametros(Sistema *sistema) {
+    iniciar_quadro(sistema, ESTADO_CONFIGURAR_PARAMETROS);
     ssd1306_fill(&sistema->tela, false);
 
     const char *nomes_parametros[] = {"A", "B", "C", "D"};
     char buffer[20];
+    const char *fim = buffer + sizeof(buffer);
 
     // Título
-    snprintf(buffer, sizeof(buffer), "CONFIGURAR %s:", nomes_parametros[sistema->indice_parametro_atual]);
+    char *texto = texto_anexar(buffer, fim, "CONFIGURAR ");
+    texto = texto_anexar(texto, fim, nomes_parametros[sistema->indice_parametro_atual]);
+    texto_anexar(texto, fim, ":");
     ssd1306_draw_string(&sistema->tela, buffer, 0, 0, false);
 
     // Valor atual do parâmetro selecionado
-    snprintf(buffer, sizeof(buffer), "Valor: %.2f", sistema->parametros[sistema->indice_parametro_atual]);
-    ssd1306_draw_string(&sistema->tela, buffer, 0, 20, false);
+    ssd1306_draw_string(&sistema->tela, "Valor: ", 0, 20, false);
+    texto_desenhar_numero(&sistema->tela, sistema->parametros[sistema->indice_parametro_atual], 2, 0, 56, 20, false);
 
     // Exibir valores de A e B na mesma linha
-    snprintf(buffer, sizeof(buffer), "A:%.2f B:%.2f", sistema->parametros[0], sistema->parametros[1]);
+    formatar_par(buffer, fim, "A:", sistema->parametros[0], "B:", sistema->parametros[1]);
     ssd1306_draw_string(&sistema->tela, buffer, 0, 30, false);
 
     // Exibir valores de C e D embaixo
-    snprintf(buffer, sizeof(buffer), "C:%.2f D:%.2f", sistema->parametros[2], sistema->parametros[3]);
+    formatar_par(buffer, fim, "C:", sistema->parametros[2], "D:", sistema->parametros[3]);
     ssd1306_draw_string(&sistema->tela, buffer, 0, 40, false);
 
     // Instruções
     ssd1306_draw_string(&sistema->tela, "BTN: Confirmar", 0, 50, false);
 
-    ssd1306_send_data(&sistema->tela);
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_CONFIGURAR_PARAMETROS, sistema->funcao_selecionada);
+    enviar_tela(sistema);
 }
 
 void desenhar_tela_valores_quadratica(Sistema *sistema) {
+    iniciar_quadro(sistema, ESTADO_EXIBIR_VALORES);
     ssd1306_fill(&sistema->tela, false);
 
     float a = sistema->parametros[0];
@@ -105,413 +371,1039 @@ void desenhar_tela_valores_quadratica(Sistema *sistema) {
     float xv = -b / (2 * a);
     float yv = -delta / (4 * a);  // Correção da fórmula para yv
 
-    char buffer[30];
-
     // Exibir xv
-    snprintf(buffer, sizeof(buffer), "Xv: %.2f", xv);
-    ssd1306_draw_string(&sistema->tela, buffer, 0, 0, false);
+    ssd1306_draw_string(&sistema->tela, "Xv: ", 0, 0, false);
+    texto_desenhar_numero(&sistema->tela, xv, 2, 0, 32, 0, false);
 
     // Exibir yv
-    snprintf(buffer, sizeof(buffer), "Yv: %.2f", yv);
-    ssd1306_draw_string(&sistema->tela, buffer, 0, 10, false);
+    ssd1306_draw_string(&sistema->tela, "Yv: ", 0, 10, false);
+    texto_desenhar_numero(&sistema->tela, yv, 2, 0, 32, 10, false);
 
     // Exibir delta
-    snprintf(buffer, sizeof(buffer), "Delta: %.2f", delta);
-    ssd1306_draw_string(&sistema->tela, buffer, 0, 20, false);
+    ssd1306_draw_string(&sistema->tela, "Delta: ", 0, 20, false);
+    texto_desenhar_numero(&sistema->tela, delta, 2, 0, 56, 20, false);
 
     // Instruções
     ssd1306_draw_string(&sistema->tela, "BTN: Voltar", 0, 50, false);
 
-    ssd1306_send_data(&sistema->tela);
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_VALORES, sistema->funcao_selecionada);
+    enviar_tela(sistema);
 }
 
-void plotar_grafico_funcao_afim(Sistema *sistema) {
-    // Limpar o display
-    ssd1306_fill(&sistema->tela, false);
+// Funções avaliadas pelo traçado da curva
+static float avaliar_afim(const float *p, float x) {
+    return p[0] * x + p[1];                      // y = ax + b
+}
 
-    // Parâmetros de visualização
-    int centro_x = 64;  // Centro do display no eixo X
-    int centro_y = 32;  // Centro do display no eixo Y
-    float escala_x = sistema->nivel_zoom;  // Escala para o eixo X
-    float escala_y = 0.5 * sistema->nivel_zoom;  // Escala para o eixo Y (ajustada para melhor visualização)
-
-    // Desenhar os eixos
-    ssd1306_vline(&sistema->tela, centro_x, 0, 63, true);  // Eixo Y
-    ssd1306_hline(&sistema->tela, 0, 127, centro_y, true); // Eixo X
-
-    // Configuração dos marcadores nos eixos
-    int espacamento_x = 5;  // Espaçamento entre os números no eixo X
-    int espacamento_y = 5;  // Espaçamento entre os números no eixo Y
-
-    // Desenhar marcadores no eixo X
-    for (int i = -30; i <= 30; i += espacamento_x) {
-        int x_pos = centro_x + (int)((i - sistema->posicao_central_x) * escala_x);
-        if (x_pos >= 0 && x_pos < 128) {
-            // Desenhar marcador
-            ssd1306_vline(&sistema->tela, x_pos, centro_y - 2, centro_y + 2, true);
-
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, x_pos - 4, centro_y + 4, true);
-            }
-        }
+static float avaliar_quadratica(const float *p, float x) {
+    return p[0] * x * x + p[1] * x + p[2];       // y = ax² + bx + c
+}
+
+static float avaliar_senoidal(const float *p, float x) {
+    return p[0] + p[1] * sin(p[2] * x + p[3]);   // y = a + b * sin(c * x + d)
+}
+
+static float avaliar_cossenoidal(const float *p, float x) {
+    return p[0] + p[1] * cos(p[2] * x + p[3]);   // y = a + b * cos(c * x + d)
+}
+
+// Derivadas analíticas, usadas na leitura do cursor
+static float derivar_afim(const float *p, float x) {
+    return p[0];
+}
+
+static float derivar_quadratica(const float *p, float x) {
+    return 2 * p[0] * x + p[1];
+}
+
+static float derivar_senoidal(const float *p, float x) {
+    return p[1] * p[2] * cos(p[2] * x + p[3]);
+}
+
+static float derivar_cossenoidal(const float *p, float x) {
+    return -p[1] * p[2] * sin(p[2] * x + p[3]);
+}
+
+// Só as funções y = f(x); paramétrica e polar são traçadas por curvas.c
+static const FuncaoAvaliacao avaliadores[TOTAL_FUNCOES] = {
+    avaliar_afim, avaliar_quadratica, avaliar_senoidal, avaliar_cossenoidal
+};
+static const FuncaoAvaliacao derivadas[TOTAL_FUNCOES] = {
+    derivar_afim, derivar_quadratica, derivar_senoidal, derivar_cossenoidal
+};
+
+// Recalcula a transformação somente quando zoom, escala ou centro mudam
+static const TransformacaoVista *obter_vista(const Sistema *sistema) {
+    if (vista_valida && vista_zoom == sistema->nivel_zoom && vista_fator_y == sistema->fator_escala_y &&
+        vista_centro_x == sistema->posicao_central_x && vista_centro_y == sistema->posicao_central_y) {
+        return &vista;
     }
 
-    // Desenhar marcadores no eixo Y
-    for (int i = -30; i <= 30; i += espacamento_y) {
-        int y_pos = centro_y - (int)(i * escala_y);  // Ajustado para posição central
-        if (y_pos >= 0 && y_pos < 64) {
-            // Desenhar marcador
-            ssd1306_hline(&sistema->tela, centro_x - 2, centro_x + 2, y_pos, true);
+    // O eixo Y usa metade do zoom, multiplicada pelo seu próprio fator
+    vista.escala_x = sistema->nivel_zoom;
+    vista.escala_y = 0.5f * sistema->nivel_zoom * sistema->fator_escala_y;
+    vista.passo_x = 1.0f / vista.escala_x;
+    vista.x_inicial = sistema->posicao_central_x - CENTRO_X * vista.passo_x;
+    vista.coluna_zero = CENTRO_X - sistema->posicao_central_x * vista.escala_x;
+    vista.linha_zero = CENTRO_Y + sistema->posicao_central_y * vista.escala_y;
+
+    vista_zoom = sistema->nivel_zoom;
+    vista_fator_y = sistema->fator_escala_y;
+    vista_centro_x = sistema->posicao_central_x;
+    vista_centro_y = sistema->posicao_central_y;
+    vista_valida = true;
+    vista_geracao++;
+    return &vista;
+}
 
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, centro_x + 4, y_pos - 2, true);
-            }
+// Menor passo 1, 2 ou 5 x 10^n que deixa os marcadores a pelo menos espaco_px
+static float passo_marcadores(float escala, float espaco_px) {
+    float minimo = espaco_px / escala;
+    float base = powf(10.0f, floorf(log10f(minimo)));
+    if (base >= minimo) return base;
+    if (2 * base >= minimo) return 2 * base;
+    if (5 * base >= minimo) return 5 * base;
+    return 10 * base;
+}
+
+// Rótulo de um marcador com as casas decimais que o passo exige
+static void formatar_marcador(char *buffer, size_t tamanho, float valor, float passo) {
+    int casas = passo >= 1.0f ? 0 : (int)ceilf(-log10f(passo) - 0.001f);
+    if (casas > 3) casas = 3;
+    texto_numero(buffer, buffer + tamanho, valor, (uint8_t)casas, 0);
+}
+
+// Largura em pixels de um texto desenhado com números pequenos
+static int largura_rotulo(const char *texto) {
+    int largura = 0;
+    for (; *texto; texto++) {
+        largura += (*texto >= '0' && *texto <= '9') ? 5 : 8;
+    }
+    return largura;
+}
+
+// Quantidade de marcadores entre os índices k_inicio e k_fim, ou 0 se o
+// intervalo não é finito ou os índices já não se distinguem em float
+static int contar_marcadores(float k_inicio, float k_fim) {
+    if (!isfinite(k_inicio) || !isfinite(k_fim) || k_fim < k_inicio ||
+        fabsf(k_inicio) >= MARCADOR_INDICE_MAXIMO || fabsf(k_fim) >= MARCADOR_INDICE_MAXIMO) {
+        return 0;
+    }
+    float quantidade = k_fim - k_inicio + 1;
+    return quantidade > MARCADORES_MAXIMO ? MARCADORES_MAXIMO : (int)quantidade;
+}
+
+// Eixos, marcadores e rótulos (refeitos apenas quando a vista muda). O passo
+// dos marcadores acompanha a escala; com um eixo fora da tela os marcadores
+// ficam presos à borda mais próxima.
+static void desenhar_eixos(const TransformacaoVista *v) {
+    ssd1306_t *alvo = &camada_eixos.alvo;
+    camada_limpar(&camada_eixos);
+
+    float linha_eixo = v->linha_zero;
+    float coluna_eixo = v->coluna_zero;
+    if (linha_eixo >= 0 && linha_eixo < SSD1306_ALTURA) {
+        ssd1306_hline(alvo, 0, SSD1306_LARGURA - 1, (int)linha_eixo, true);  // Eixo X
+    }
+    if (coluna_eixo >= 0 && coluna_eixo < SSD1306_LARGURA) {
+        ssd1306_vline(alvo, (int)coluna_eixo, 0, SSD1306_ALTURA - 1, true);  // Eixo Y
+    }
+    int linha = linha_eixo < 2 ? 2 : (linha_eixo > SSD1306_ALTURA - 3 ? SSD1306_ALTURA - 3 : (int)linha_eixo);
+    int coluna = coluna_eixo < 2 ? 2 : (coluna_eixo > SSD1306_LARGURA - 3 ? SSD1306_LARGURA - 3 : (int)coluna_eixo);
+    char buffer[10];
+
+    // Marcadores no eixo X, com rótulo abaixo (ou acima, perto da borda inferior)
+    float passo = passo_marcadores(v->escala_x, MARCADOR_ESPACO_X);
+    float k_inicio = ceilf(v->x_inicial / passo);
+    float k_fim = floorf((v->x_inicial + (SSD1306_LARGURA - 1) * v->passo_x) / passo);
+    int y_rotulo = linha + 4 <= SSD1306_ALTURA - 8 ? linha + 4 : linha - 10;
+    int fim_rotulo = -1;
+    int quantidade = contar_marcadores(k_inicio, k_fim);
+    for (int i = 0; i < quantidade; i++) {
+        float k = k_inicio + i;
+        int x_pos = (int)(v->coluna_zero + k * passo * v->escala_x);
+        ssd1306_vline(alvo, x_pos, linha - 2, linha + 2, true);
+        if (k == 0) {
+            continue;
+        }
+
+        formatar_marcador(buffer, sizeof(buffer), k * passo, passo);
+        int largura = largura_rotulo(buffer);
+        int x_texto = x_pos - largura / 2;
+        if (x_texto < 0) x_texto = 0;
+        if (x_texto + largura > SSD1306_LARGURA) x_texto = SSD1306_LARGURA - largura;
+        if (x_texto > fim_rotulo) {  // Rótulos não se sobrepõem
+            ssd1306_draw_string(alvo, buffer, x_texto, y_rotulo, true);
+            fim_rotulo = x_texto + largura;
         }
     }
 
-    // Plotar a função afim usando mais pontos para suavizar a linha
-    float a = sistema->parametros[0];
-    float b = sistema->parametros[1];
+    // Marcadores no eixo Y, com rótulo à direita (ou à esquerda, perto da borda)
+    passo = passo_marcadores(v->escala_y, MARCADOR_ESPACO_Y);
+    k_inicio = ceilf((v->linha_zero - (SSD1306_ALTURA - 1)) / v->escala_y / passo);
+    k_fim = floorf(v->linha_zero / v->escala_y / passo);
+    quantidade = contar_marcadores(k_inicio, k_fim);
+    for (int i = 0; i < quantidade; i++) {
+        float k = k_inicio + i;
+        int y_pos = (int)(v->linha_zero - k * passo * v->escala_y);
+        ssd1306_hline(alvo, coluna - 2, coluna + 2, y_pos, true);
+        if (k == 0) {
+            continue;
+        }
 
-    int ultimo_y_pos = -1;
-    for (int px = 0; px < 128; px++) {
-        // Converter coordenada do pixel para coordenada matemática
-        float x_val = (px - centro_x) / escala_x + sistema->posicao_central_x;
+        formatar_marcador(buffer, sizeof(buffer), k * passo, passo);
+        int largura = largura_rotulo(buffer);
+        int x_texto = coluna + 4 + largura <= SSD1306_LARGURA ? coluna + 4 : coluna - 4 - largura;
+        int y_texto = y_pos - 2 < 0 ? 0 : y_pos - 2;
+        ssd1306_draw_string(alvo, buffer, x_texto < 0 ? 0 : x_texto, y_texto, true);
+    }
+
+    eixos_geracao = vista_geracao;
+    eixos_validos = true;
+}
+
+// Obtém um valor por coluna em amostras_y; o cache só avalia os pontos que
+// ainda não conhece na resolução da vista e interpola com erro de até meio pixel
+static void amostrar_curva(Sistema *sistema, const TransformacaoVista *v, FuncaoAvaliacao avaliar) {
+    cache_amostras_preencher(sistema->funcao_selecionada, sistema->parametros, avaliar,
+                             v->x_inicial, v->passo_x, 0.5f / v->escala_y, sistema->amostras_y, SSD1306_LARGURA);
+}
 
-        // Calcular y = ax + b
-        float y_val = a * x_val + b;
+// Traçado da curva a partir das amostras, um ponto por coluna
+static void desenhar_amostras(Sistema *sistema, const TransformacaoVista *v) {
+    ssd1306_t *alvo = &camada_curva.alvo;
+    camada_limpar(&camada_curva);
 
-        // Converter coordenada matemática para coordenada do pixel
-        int y_pos = centro_y - (int)(y_val * escala_y);
+    int ultimo_y_pos = -1;
+    for (int px = 0; px < SSD1306_LARGURA; px++) {
+        // Converter coordenada matemática para coordenada do pixel; valores
+        // muito fora da tela são descartados antes da conversão para int
+        float y_tela = v->linha_zero - sistema->amostras_y[px] * v->escala_y;
+        if (!(y_tela >= 0 && y_tela < SSD1306_ALTURA)) {
+            continue;
+        }
+        int y_pos = (int)y_tela;
 
-        // Verificar se está dentro dos limites do display
-        if (y_pos >= 0 && y_pos < 64) {
-            ssd1306_pixel(&sistema->tela, px, y_pos, true);
+        ssd1306_pixel(alvo, px, y_pos, true);
 
-            // Conectar os pontos para uma linha mais suave
-            if (ultimo_y_pos != -1 && abs(y_pos - ultimo_y_pos) > 1) {
-                int inicio = (ultimo_y_pos < y_pos) ? ultimo_y_pos : y_pos;
-                int fim = (ultimo_y_pos < y_pos) ? y_pos : ultimo_y_pos;
+        // Conectar os pontos para uma curva mais suave (linha vertical)
+        if (ultimo_y_pos != -1 && abs(y_pos - ultimo_y_pos) > 1) {
+            int inicio = (ultimo_y_pos < y_pos) ? ultimo_y_pos : y_pos;
+            int fim = (ultimo_y_pos < y_pos) ? y_pos : ultimo_y_pos;
 
-                for (int y = inicio; y <= fim; y++) {
-                    if (y >= 0 && y < 64) {
-                        ssd1306_pixel(&sistema->tela, px - 1, y, true);
-                    }
+            for (int y = inicio; y <= fim; y++) {
+                if (y >= 0 && y < SSD1306_ALTURA) {
+                    ssd1306_pixel(alvo, px - 1, y, true);
                 }
             }
-
-            ultimo_y_pos = y_pos;
         }
+
+        ultimo_y_pos = y_pos;
     }
+}
 
-    // Informações sobre o zoom (mantido na parte inferior)
-    char info_zoom[20];
-    snprintf(info_zoom, sizeof(info_zoom), "Zoom: %.1fx", sistema->nivel_zoom);
-    ssd1306_draw_string(&sistema->tela, info_zoom, 0, 55, true);
+// Linha da tela para um valor de y, presa à área visível
+static int linha_limitada(const TransformacaoVista *v, float y) {
+    float linha = v->linha_zero - y * v->escala_y;
+    if (!(linha >= 0)) return 0;
+    if (linha > SSD1306_ALTURA - 1) return SSD1306_ALTURA - 1;
+    return (int)linha;
+}
 
-    // Enviar os dados para o display
-    ssd1306_send_data(&sistema->tela);
+// Trapézios de a até b com o passo da tela, limitados a ANALISE_AMOSTRAS_FORA;
+// devolve em *aproximada se o passo precisou aumentar
+static float integrar_trecho(FuncaoAvaliacao avaliar, const float *parametros, float a, float b,
+                             float passo, bool *aproximada) {
+    if (!(b > a)) {
+        return 0.0f;
+    }
+    float intervalos = ceilf((b - a) / passo);
+    uint32_t n = ANALISE_AMOSTRAS_FORA;
+    if (intervalos < ANALISE_AMOSTRAS_FORA) {
+        n = intervalos < 1 ? 1 : (uint32_t)intervalos;
+    } else if (intervalos > ANALISE_AMOSTRAS_FORA) {
+        *aproximada = true;
+    }
+
+    float h = (b - a) / n;
+    float soma = 0.5f * (avaliar(parametros, a) + avaliar(parametros, b));
+    for (uint32_t i = 1; i < n; i++) {
+        soma += avaliar(parametros, a + i * h);
+    }
+    return soma * h;
 }
 
-void plotar_grafico_funcao_quadratica(Sistema *sistema) {
-    // Limpar o display
-    ssd1306_fill(&sistema->tela, false);
+// Parte da integral fora da tela, refeita só quando a função, os limites ou a
+// vista mudam (a parte visível sai das amostras a cada quadro)
+static struct {
+    bool valida;
+    TipoFuncao funcao;
+    float parametros[4];
+    float x_menor, x_maior, x_inicial, passo_x;
+    float valor;
+    bool aproximada;
+} integral_fora;
+
+static float integral_fora_da_tela(Sistema *sistema, const TransformacaoVista *v,
+                                   float x_menor, float x_maior, bool *aproximada) {
+    if (!integral_fora.valida || integral_fora.funcao != sistema->funcao_selecionada ||
+        memcmp(integral_fora.parametros, sistema->parametros, sizeof(integral_fora.parametros)) != 0 ||
+        integral_fora.x_menor != x_menor || integral_fora.x_maior != x_maior ||
+        integral_fora.x_inicial != v->x_inicial || integral_fora.passo_x != v->passo_x) {
+        FuncaoAvaliacao avaliar = avaliadores[sistema->funcao_selecionada];
+        float x_ultima = v->x_inicial + (SSD1306_LARGURA - 1) * v->passo_x;
+        integral_fora.aproximada = false;
+        integral_fora.valor =
+            integrar_trecho(avaliar, sistema->parametros, x_menor, fminf(x_maior, v->x_inicial),
+                            v->passo_x, &integral_fora.aproximada) +
+            integrar_trecho(avaliar, sistema->parametros, fmaxf(x_menor, x_ultima), x_maior,
+                            v->passo_x, &integral_fora.aproximada);
+        integral_fora.funcao = sistema->funcao_selecionada;
+        memcpy(integral_fora.parametros, sistema->parametros, sizeof(integral_fora.parametros));
+        integral_fora.x_menor = x_menor;
+        integral_fora.x_maior = x_maior;
+        integral_fora.x_inicial = v->x_inicial;
+        integral_fora.passo_x = v->passo_x;
+        integral_fora.valida = true;
+    }
+    *aproximada = integral_fora.aproximada;
+    return integral_fora.valor;
+}
 
-    // Parâmetros de visualização
-    int centro_x = 64;  // Centro do display no eixo X
-    int centro_y = 32;  // Centro do display no eixo Y
-    float escala_x = sistema->nivel_zoom;  // Escala para o eixo X
-    float escala_y = 0.5 * sistema->nivel_zoom;  // Escala para o eixo Y (ajustada para melhor visualização)
-
-    // Desenhar os eixos
-    ssd1306_vline(&sistema->tela, centro_x, 0, 63, true);  // Eixo Y
-    ssd1306_hline(&sistema->tela, 0, 127, centro_y, true); // Eixo X
-
-    // Configuração dos marcadores nos eixos
-    int espacamento_x = 5;  // Espaçamento entre os números no eixo X
-    int espacamento_y = 5;  // Espaçamento entre os números no eixo Y
-
-    // Desenhar marcadores no eixo X
-    for (int i = -30; i <= 30; i += espacamento_x) {
-        int x_pos = centro_x + (int)((i - sistema->posicao_central_x) * escala_x);
-        if (x_pos >= 0 && x_pos < 128) {
-            // Desenhar marcador
-            ssd1306_vline(&sistema->tela, x_pos, centro_y - 2, centro_y + 2, true);
-
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, x_pos - 4, centro_y + 4, true);
+// Derivada, integral e área em uma única varredura das amostras já obtidas:
+// a derivada sai das diferenças centrais entre colunas vizinhas e a integral
+// soma trapézios entre os limites; o que passa da tela é somado com
+// avaliações extras, então o valor não depende da vista
+static void desenhar_analise(Sistema *sistema, const TransformacaoVista *v) {
+    ssd1306_t *alvo = &camada_analise.alvo;
+    camada_limpar(&camada_analise);
+    Analise *analise = &sistema->analise;
+    const float *y = sistema->amostras_y;
+
+    // Limites em colunas fracionárias
+    float x_menor = fminf(analise->x_inicio, analise->x_fim);
+    float x_maior = fmaxf(analise->x_inicio, analise->x_fim);
+    float inicio = (x_menor - v->x_inicial) / v->passo_x;
+    float fim = (x_maior - v->x_inicial) / v->passo_x;
+    float integral = 0.0f;
+    analise->aproximada = false;
+    if (inicio < 0 || fim > SSD1306_LARGURA - 1) {
+        integral = integral_fora_da_tela(sistema, v, x_menor, x_maior, &analise->aproximada);
+    }
+    if (inicio < 0) inicio = 0;
+    if (fim > SSD1306_LARGURA - 1) fim = SSD1306_LARGURA - 1;
+    int coluna_inicio = (int)ceilf(inicio);
+    int coluna_fim = (int)floorf(fim);
+    int linha_eixo = linha_limitada(v, 0.0f);
+
+    int ultima_linha_d = -1;
+    for (int px = 0; px < SSD1306_LARGURA; px++) {
+        // Trapézio entre px e px + 1, só na parte dentro dos limites
+        if (px < SSD1306_LARGURA - 1) {
+            float a = fmaxf((float)px, inicio);
+            float b = fminf((float)(px + 1), fim);
+            if (b > a) {
+                float inclinacao = y[px + 1] - y[px];
+                float ya = y[px] + inclinacao * (a - px);
+                float yb = y[px] + inclinacao * (b - px);
+                integral += 0.5f * (ya + yb) * (b - a) * v->passo_x;
             }
         }
+
+        // Área: coluna do eixo até a curva preenchida byte a byte; colunas
+        // alternadas formam a hachura e as bordas marcam os limites
+        if (px >= coluna_inicio && px <= coluna_fim &&
+            ((px & 1) == 0 || px == coluna_inicio || px == coluna_fim)) {
+            int linha = linha_limitada(v, y[px]);
+            ssd1306_vline(alvo, px, linha < linha_eixo ? linha : linha_eixo,
+                          linha < linha_eixo ? linha_eixo : linha, true);
+        }
+
+        // Derivada tracejada, ligando os pontos dentro de cada traço
+        if ((px / ANALISE_TRACO) & 1) {
+            ultima_linha_d = -1;
+            continue;
+        }
+        int anterior = px > 0 ? px - 1 : px;
+        int seguinte = px < SSD1306_LARGURA - 1 ? px + 1 : px;
+        float derivada = (y[seguinte] - y[anterior]) / ((seguinte - anterior) * v->passo_x);
+        float linha_d = v->linha_zero - derivada * v->escala_y;
+        if (!(linha_d >= 0 && linha_d < SSD1306_ALTURA)) {
+            ultima_linha_d = -1;
+            continue;
+        }
+        int linha = (int)linha_d;
+        if (ultima_linha_d >= 0 && abs(linha - ultima_linha_d) > 1) {
+            ssd1306_vline(alvo, px - 1, linha < ultima_linha_d ? linha : ultima_linha_d,
+                          linha < ultima_linha_d ? ultima_linha_d : linha, true);
+        }
+        ssd1306_pixel(alvo, px, linha, true);
+        ultima_linha_d = linha;
     }
 
-    // Desenhar marcadores no eixo Y
-    for (int i = -30; i <= 30; i += espacamento_y) {
-        int y_pos = centro_y - (int)(i * escala_y);  // Ajustado para posição central
-        if (y_pos >= 0 && y_pos < 64) {
-            // Desenhar marcador
-            ssd1306_hline(&sistema->tela, centro_x - 2, centro_x + 2, y_pos, true);
+    analise->integral = integral;
+}
+
+// Informações sobre o zoom (mantido na parte inferior)
+static void desenhar_hud(Sistema *sistema) {
+    ssd1306_t *alvo = &camada_hud.alvo;
+    camada_limpar(&camada_hud);
+
+    ssd1306_draw_string(alvo, "Zoom: ", 0, 55, true);
+    uint8_t x = texto_desenhar_numero(alvo, sistema->nivel_zoom, 1, 0, 48, 55, true);
+    ssd1306_draw_char(alvo, 'x', x, 55, true);
+
+    // Integral da análise (ou parâmetro em animação) no canto direito
+    if (sistema->analise.ativa && funcao_cartesiana(sistema->funcao_selecionada)) {
+        char info_integral[16];
+        texto_numero(texto_anexar(info_integral, info_integral + sizeof(info_integral),
+                                  sistema->analise.aproximada ? "S~" : "S:"),
+                     info_integral + sizeof(info_integral), sistema->analise.integral, 2, 0);
+        int largura = largura_rotulo(info_integral);
+        ssd1306_draw_string(alvo, info_integral, largura > 48 ? SSD1306_LARGURA - largura : 80, 55, true);
+    } else if (sistema->animacao.ativa) {
+        const char nomes_parametros[] = {'A', 'B', 'C', 'D'};
+        uint8_t indice = sistema->animacao.indice_parametro;
+        ssd1306_draw_char(alvo, nomes_parametros[indice], 80, 55, true);
+        ssd1306_draw_char(alvo, ':', 88, 55, true);
+        texto_desenhar_numero(alvo, sistema->parametros[indice], 2, 0, 96, 55, true);
+    }
 
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, centro_x + 4, y_pos - 2, true);
-            }
+    hud_zoom = sistema->nivel_zoom;
+    hud_valido = true;
+}
+
+// Cursor de leitura: linha pontilhada e marcador desenhados com XOR sobre a
+// tela já composta, assim desenhar de novo no mesmo lugar apaga o cursor e
+// movê-lo só exige reenviar as colunas afetadas e a leitura
+static void inverter_pixel(uint8_t *pixels, int x, int y) {
+    if (x >= 0 && x < SSD1306_LARGURA && y >= 0 && y < CURSOR_LINHAS) {
+        pixels[(y / 8) * SSD1306_LARGURA + x] ^= 1u << (y % 8);
+    }
+}
+
+static void inverter_cursor(Sistema *sistema, int coluna, int linha) {
+    uint8_t *pixels = sistema->tela.ram_buffer + 1;
+    for (int pagina = 0; pagina < CURSOR_PAGINAS; pagina++) {
+        pixels[pagina * SSD1306_LARGURA + coluna] ^= 0x55;  // Linha pontilhada
+    }
+    if (linha >= 0) {
+        // Marcador 3x3 na curva (a coluna central já foi invertida pela linha)
+        for (int dy = -1; dy <= 1; dy++) {
+            inverter_pixel(pixels, coluna - 1, linha + dy);
+            inverter_pixel(pixels, coluna + 1, linha + dy);
         }
     }
+}
 
-    // Plotar a função quadrática usando mais pontos para suavizar a curva
-    float a = sistema->parametros[0];
-    float b = sistema->parametros[1];
-    float c = sistema->parametros[2];
+// Escreve x, f(x) e f'(x) nas páginas de leitura; retorna a largura usada
+static uint8_t desenhar_leitura(Sistema *sistema, const TransformacaoVista *v) {
+    uint8_t *pixels = sistema->tela.ram_buffer + 1;
+    memset(pixels + LEITURA_PAGINA * SSD1306_LARGURA, 0, 2 * SSD1306_LARGURA);
+
+    float x = v->x_inicial + sistema->cursor_coluna * v->passo_x;
+    float y = avaliadores[sistema->funcao_selecionada](sistema->parametros, x);
+    float dy = derivadas[sistema->funcao_selecionada](sistema->parametros, x);
+
+    char linha_xy[24];
+    char linha_d[28];
+    formatar_par(linha_xy, linha_xy + sizeof(linha_xy), "X", x, "Y", y);
+    if (sistema->analise.ativa) {
+        // A leitura cobre o HUD, então a integral vai junto da derivada
+        formatar_par(linha_d, linha_d + sizeof(linha_d), "D", dy,
+                     sistema->analise.aproximada ? "S~" : "S", sistema->analise.integral);
+    } else {
+        texto_numero(texto_anexar(linha_d, linha_d + sizeof(linha_d), "D"),
+                     linha_d + sizeof(linha_d), dy, 2, 0);
+    }
+    ssd1306_draw_string(&sistema->tela, linha_xy, 0, LEITURA_PAGINA * 8, true);
+    ssd1306_draw_string(&sistema->tela, linha_d, 0, LEITURA_PAGINA * 8 + 8, true);
 
-    int ultimo_y_pos = -1;
-    for (int px = 0; px < 128; px++) {
-        // Converter coordenada do pixel para coordenada matemática
-        float x_val = (px - centro_x) / escala_x + sistema->posicao_central_x;
+    int largura = largura_rotulo(linha_xy);
+    int largura_d = largura_rotulo(linha_d);
+    if (largura_d > largura) largura = largura_d;
+    return largura > SSD1306_LARGURA ? SSD1306_LARGURA : largura;
+}
 
-        // Calcular y = ax² + bx + c
-        float y_val = a * x_val * x_val + b * x_val + c;
+// Desenha leitura e cursor na tela composta e guarda o que foi invertido
+static void desenhar_cursor(Sistema *sistema, const TransformacaoVista *v) {
+    leitura_largura = desenhar_leitura(sistema, v);
 
-        // Converter coordenada matemática para coordenada do pixel
-        int y_pos = centro_y - (int)(y_val * escala_y);
+    float linha = v->linha_zero - sistema->amostras_y[sistema->cursor_coluna] * v->escala_y;
+    cursor_linha_desenhada = (linha >= 0 && linha < CURSOR_LINHAS) ? (int16_t)linha : -1;
+    cursor_coluna_desenhada = sistema->cursor_coluna;
+    inverter_cursor(sistema, cursor_coluna_desenhada, cursor_linha_desenhada);
+}
 
-        // Verificar se está dentro dos limites do display
-        if (y_pos >= 0 && y_pos < 64) {
-            ssd1306_pixel(&sistema->tela, px, y_pos, true);
+// Colunas do sprite do cursor (linha e marcador) limitadas à tela
+static void enviar_colunas_cursor(Sistema *sistema, int inicio, int fim) {
+    if (inicio < 0) inicio = 0;
+    if (fim > SSD1306_LARGURA - 1) fim = SSD1306_LARGURA - 1;
+    ssd1306_send_janela(&sistema->tela, 0, CURSOR_PAGINAS - 1, inicio, fim);
+}
 
-            // Conectar os pontos para uma curva mais suave (linha vertical)
-            if (ultimo_y_pos != -1 && abs(y_pos - ultimo_y_pos) > 1) {
-                int inicio = (ultimo_y_pos < y_pos) ? ultimo_y_pos : y_pos;
-                int fim = (ultimo_y_pos < y_pos) ? y_pos : ultimo_y_pos;
+// Tabela de valores: cada linha ocupa uma página e a linha r fica sempre na
+// página r % 8 da RAM do display. Rolar muda o registrador de linha inicial
+// (0x40 | linha) e só a linha que entra é avaliada, desenhada e enviada.
+static uint8_t pagina_da_linha(int32_t linha) {
+    return (uint8_t)(linha & (TABELA_LINHAS - 1));
+}
 
-                for (int y = inicio; y <= fim; y++) {
-                    if (y >= 0 && y < 64) {
-                        ssd1306_pixel(&sistema->tela, px - 1, y, true);
-                    }
-                }
-            }
+// Avalia e desenha uma linha na sua página: x à esquerda e f(x) à direita
+static void desenhar_linha_tabela(Sistema *sistema, int32_t linha) {
+    TabelaValores *tabela = &sistema->tabela;
+    uint8_t pagina = pagina_da_linha(linha);
+    uint8_t *pixels = sistema->tela.ram_buffer + 1 + pagina * SSD1306_LARGURA;
+    memset(pixels, 0, SSD1306_LARGURA);
 
-            ultimo_y_pos = y_pos;
-        }
+    float x = tabela->x_inicial + linha * tabela->passo;
+    float y = avaliadores[sistema->funcao_selecionada](sistema->parametros, x);
+
+    texto_desenhar_numero(&sistema->tela, x, 2, 0, 0, pagina * 8 + 1, true);
+    texto_desenhar_numero(&sistema->tela, y, 3, 0, TABELA_COLUNA_Y, pagina * 8 + 1, true);
+    pixels[TABELA_COLUNA_Y - 4] = 0xFF;  // Divisória entre as colunas
+
+    tabela->avaliacoes++;
+}
+
+void desenhar_tela_tabela(Sistema *sistema) {
+    TabelaValores *tabela = &sistema->tabela;
+    iniciar_quadro(sistema, ESTADO_EXIBIR_TABELA);
+
+    for (int32_t linha = tabela->primeira_linha; linha < tabela->primeira_linha + TABELA_LINHAS; linha++) {
+        desenhar_linha_tabela(sistema, linha);
     }
 
-    // Informações sobre o zoom (mantido na parte inferior)
-    char info_zoom[20];
-    snprintf(info_zoom, sizeof(info_zoom), "Zoom: %.1fx", sistema->nivel_zoom);
-    ssd1306_draw_string(&sistema->tela, info_zoom, 0, 55, true);
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_TABELA, sistema->funcao_selecionada);
+    enviar_tela(sistema);
+    ssd1306_definir_linha_inicial(&sistema->tela, pagina_da_linha(tabela->primeira_linha) * 8);
+}
 
-    // Enviar os dados para o display
-    ssd1306_send_data(&sistema->tela);
+// Abre a tabela com a linha do centro do gráfico na quarta posição
+void iniciar_tabela(Sistema *sistema) {
+    TabelaValores *tabela = &sistema->tabela;
+    if (!funcao_cartesiana(sistema->funcao_selecionada)) {
+        return;
+    }
+    if (tabela->indice_passo >= TABELA_TOTAL_PASSOS) {
+        tabela->indice_passo = TABELA_PASSO_PADRAO;
+    }
+    tabela->passo = passos_tabela[tabela->indice_passo];
+    tabela->x_inicial = roundf(sistema->posicao_central_x / tabela->passo) * tabela->passo;
+    tabela->primeira_linha = -(TABELA_LINHAS / 2 - 1);
+    desenhar_tela_tabela(sistema);
 }
 
-void plotar_grafico_funcao_senoidal(Sistema *sistema) {
-    // Limpar o display
-    ssd1306_fill(&sistema->tela, false);
+void rolar_tabela(Sistema *sistema, int32_t linhas) {
+    TabelaValores *tabela = &sistema->tabela;
+    if (linhas == 0 || !funcao_cartesiana(sistema->funcao_selecionada)) {
+        return;
+    }
+    if (linhas >= TABELA_LINHAS || linhas <= -TABELA_LINHAS) {
+        // Nenhuma linha visível continua na tela
+        tabela->primeira_linha += linhas;
+        desenhar_tela_tabela(sistema);
+        return;
+    }
 
-    // Parâmetros de visualização
-    int centro_x = 64;  // Centro do display no eixo X
-    int centro_y = 32;  // Centro do display no eixo Y
-    float escala_x = sistema->nivel_zoom;  // Escala para o eixo X
-    float escala_y = 0.5 * sistema->nivel_zoom;  // Escala para o eixo Y (ajustada para melhor visualização)
-
-    // Desenhar os eixos
-    ssd1306_vline(&sistema->tela, centro_x, 0, 63, true);  // Eixo Y
-    ssd1306_hline(&sistema->tela, 0, 127, centro_y, true); // Eixo X
-
-    // Configuração dos marcadores nos eixos
-    int espacamento_x = 5;  // Espaçamento entre os números no eixo X
-    int espacamento_y = 5;  // Espaçamento entre os números no eixo Y
-
-    // Desenhar marcadores no eixo X
-    for (int i = -30; i <= 30; i += espacamento_x) {
-        int x_pos = centro_x + (int)((i - sistema->posicao_central_x) * escala_x);
-        if (x_pos >= 0 && x_pos < 128) {
-            // Desenhar marcador
-            ssd1306_vline(&sistema->tela, x_pos, centro_y - 2, centro_y + 2, true);
-
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, x_pos - 4, centro_y + 4, true);
-            }
-        }
+    iniciar_quadro(sistema, ESTADO_EXIBIR_TABELA);
+    int32_t anterior = tabela->primeira_linha;
+    tabela->primeira_linha += linhas;
+
+    // Linhas que entram: abaixo da antiga última (descendo) ou acima da antiga primeira (subindo)
+    int32_t inicio = linhas > 0 ? anterior + TABELA_LINHAS : tabela->primeira_linha;
+    int32_t fim = inicio + (linhas > 0 ? linhas : -linhas);
+    for (int32_t linha = inicio; linha < fim; linha++) {
+        desenhar_linha_tabela(sistema, linha);
     }
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_TABELA, sistema->funcao_selecionada);
 
-    // Desenhar marcadores no eixo Y
-    for (int i = -30; i <= 30; i += espacamento_y) {
-        int y_pos = centro_y - (int)(i * escala_y);  // Ajustado para posição central
-        if (y_pos >= 0 && y_pos < 64) {
-            // Desenhar marcador
-            ssd1306_hline(&sistema->tela, centro_x - 2, centro_x + 2, y_pos, true);
+    uint32_t bytes_antes = sistema->tela.bytes_enviados;
+    rastro_registrar(RASTRO_ENVIO_INICIO, 0, 0);
+    for (int32_t linha = inicio; linha < fim; linha++) {
+        ssd1306_send_trecho(&sistema->tela, pagina_da_linha(linha), 0, SSD1306_LARGURA - 1);
+    }
+    ssd1306_definir_linha_inicial(&sistema->tela, pagina_da_linha(tabela->primeira_linha) * 8);
+    rastro_registrar(RASTRO_ENVIO_FIM, 0, sistema->tela.bytes_enviados - bytes_antes);
+    sessao_contar_quadro(time_us_32() - inicio_quadro_us);
+}
 
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, centro_x + 4, y_pos - 2, true);
-            }
-        }
+// Passo entre linhas: A diminui e B aumenta, mantendo o x da primeira linha
+void alterar_passo_tabela(Sistema *sistema, int8_t sentido) {
+    TabelaValores *tabela = &sistema->tabela;
+    int novo = tabela->indice_passo + sentido;
+    if (novo < 0 || novo >= TABELA_TOTAL_PASSOS || !funcao_cartesiana(sistema->funcao_selecionada)) {
+        return;
     }
+    tabela->x_inicial += tabela->primeira_linha * tabela->passo;
+    tabela->primeira_linha = 0;
+    tabela->indice_passo = novo;
+    tabela->passo = passos_tabela[novo];
+    desenhar_tela_tabela(sistema);
+    printf("Tabela: passo %s\n", texto_decimal(tabela->passo, 2));
+}
 
-    // Plotar a função senoidal usando mais pontos para suavizar a curva
-    float a = sistema->parametros[0];
-    float b = sistema->parametros[1];
-    float c = sistema->parametros[2];
-    float d = sistema->parametros[3];
+void gerenciar_estado_tabela(Sistema *sistema) {
+    uint16_t leitura_y = sessao_ler_adc(0);
+    rastro_registrar(RASTRO_ADC, 0, leitura_y);
+    int16_t diferenca = (int16_t)leitura_y - 2048;
 
-    int ultimo_y_pos = -1;
-    for (int px = 0; px < 128; px++) {
-        // Converter coordenada do pixel para coordenada matemática
-        float x_val = (px - centro_x) / escala_x + sistema->posicao_central_x;
+    // Joystick para cima volta para x menores
+    if (abs(diferenca) > ZONA_MORTA) {
+        int32_t linhas = abs(diferenca) > TABELA_LIMIAR_RAPIDO ? TABELA_ROLAGEM_RAPIDA : 1;
+        rolar_tabela(sistema, diferenca > 0 ? -linhas : linhas);
+    }
+}
 
-        // Calcular y = a + b * sin(c * x + d)
-        float y_val = a + b * sin(c * x_val + d);
+bool funcao_cartesiana(TipoFuncao funcao) {
+    return funcao < TOTAL_FUNCOES && avaliadores[funcao] != NULL;
+}
 
-        // Converter coordenada matemática para coordenada do pixel
-        int y_pos = centro_y - (int)(y_val * escala_y);
+// Desenha eixos, curva (das amostras ou paramétrica), análise e HUD nas
+// camadas; devolve quantas camadas entram na composição
+static uint8_t montar_grafico(Sistema *sistema, const TransformacaoVista *v) {
+    bool cartesiana = funcao_cartesiana(sistema->funcao_selecionada);
+    if (!eixos_validos || eixos_geracao != vista_geracao) {
+        desenhar_eixos(v);
+    }
 
-        // Verificar se está dentro dos limites do display
-        if (y_pos >= 0 && y_pos < 64) {
-            ssd1306_pixel(&sistema->tela, px, y_pos, true);
+    bool analise = cartesiana && sistema->analise.ativa;
+    if (cartesiana) {
+        desenhar_amostras(sistema, v);
+        if (analise) {
+            desenhar_analise(sistema, v);
+        }
+    } else {
+        camada_limpar(&camada_curva);
+        curva_desenhar(&camada_curva.alvo, v, sistema->funcao_selecionada, sistema->parametros);
+    }
 
-            // Conectar os pontos para uma curva mais suave (linha vertical)
-            if (ultimo_y_pos != -1 && abs(y_pos - ultimo_y_pos) > 1) {
-                int inicio = (ultimo_y_pos < y_pos) ? ultimo_y_pos : y_pos;
-                int fim = (ultimo_y_pos < y_pos) ? y_pos : ultimo_y_pos;
+    if (!hud_valido || hud_zoom != sistema->nivel_zoom || sistema->animacao.ativa || analise) {
+        desenhar_hud(sistema);
+    }
 
-                for (int y = inicio; y <= fim; y++) {
-                    if (y >= 0 && y < 64) {
-                        ssd1306_pixel(&sistema->tela, px - 1, y, true);
-                    }
-                }
-            }
+    return analise ? 4 : 3;
+}
 
-            ultimo_y_pos = y_pos;
+// Monta as camadas, compõe e envia o quadro
+static void finalizar_grafico(Sistema *sistema, const TransformacaoVista *v) {
+    bool cartesiana = funcao_cartesiana(sistema->funcao_selecionada);
+    uint8_t quantidade = montar_grafico(sistema, v);
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_GRAFICO, sistema->funcao_selecionada);
+
+    // Combinar as camadas e enviar os dados para o display
+    if (escala_cinza_ativa()) {
+        // Os subquadros são enviados por atualizar_escala_cinza
+        escala_cinza_compor(camadas_grafico, niveis_grafico, quantidade);
+#if SEGUNDA_TELA_ATIVA
+        atualizar_painel_dados(sistema);
+#endif
+        sessao_contar_quadro(time_us_32() - inicio_quadro_us);
+    } else {
+        camadas_compor(&sistema->tela, camadas_grafico, quantidade);
+        if (sistema->cursor_ativo && cartesiana) {
+            desenhar_cursor(sistema, v);
         }
+        enviar_tela(sistema);
     }
+    if (cartesiana) {
+        transmissao_enviar_amostras(sistema->amostras_y, SSD1306_LARGURA,
+                                    v->x_inicial, v->passo_x);
+    }
+}
 
-    // Informações sobre o zoom (mantido na parte inferior)
-    char info_zoom[20];
-    snprintf(info_zoom, sizeof(info_zoom), "Zoom: %.1fx", sistema->nivel_zoom);
-    ssd1306_draw_string(&sistema->tela, info_zoom, 0, 55, true);
+static void plotar_grafico(Sistema *sistema, FuncaoAvaliacao avaliar) {
+    iniciar_quadro(sistema, ESTADO_EXIBIR_GRAFICO);
 
-    // Enviar os dados para o display
-    ssd1306_send_data(&sistema->tela);
+    const TransformacaoVista *v = obter_vista(sistema);
+    amostrar_curva(sistema, v, avaliar);
+    finalizar_grafico(sistema, v);
+}
+
+void plotar_grafico_funcao_afim(Sistema *sistema) {
+    plotar_grafico(sistema, avaliar_afim);
+}
+
+void plotar_grafico_funcao_quadratica(Sistema *sistema) {
+    plotar_grafico(sistema, avaliar_quadratica);
+}
+
+void plotar_grafico_funcao_senoidal(Sistema *sistema) {
+    plotar_grafico(sistema, avaliar_senoidal);
 }
 
 void plotar_grafico_funcao_cossenoidal(Sistema *sistema) {
-    // Limpar o display
-    ssd1306_fill(&sistema->tela, false);
+    plotar_grafico(sistema, avaliar_cossenoidal);
+}
 
-    // Parâmetros de visualização
-    int centro_x = 64;  // Centro do display no eixo X
-    int centro_y = 32;  // Centro do display no eixo Y
-    float escala_x = sistema->nivel_zoom;  // Escala para o eixo X
-    float escala_y = 0.5 * sistema->nivel_zoom;  // Escala para o eixo Y (ajustada para melhor visualização)
-
-    // Desenhar os eixos
-    ssd1306_vline(&sistema->tela, centro_x, 0, 63, true);  // Eixo Y
-    ssd1306_hline(&sistema->tela, 0, 127, centro_y, true); // Eixo X
-
-    // Configuração dos marcadores nos eixos
-    int espacamento_x = 5;  // Espaçamento entre os números no eixo X
-    int espacamento_y = 5;  // Espaçamento entre os números no eixo Y
-
-    // Desenhar marcadores no eixo X
-    for (int i = -30; i <= 30; i += espacamento_x) {
-        int x_pos = centro_x + (int)((i - sistema->posicao_central_x) * escala_x);
-        if (x_pos >= 0 && x_pos < 128) {
-            // Desenhar marcador
-            ssd1306_vline(&sistema->tela, x_pos, centro_y - 2, centro_y + 2, true);
-
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, x_pos - 4, centro_y + 4, true);
-            }
+// Paramétrica e polar não têm amostras por coluna: a curva é traçada por segmentos
+static void plotar_curva(Sistema *sistema) {
+    iniciar_quadro(sistema, ESTADO_EXIBIR_GRAFICO);
+    finalizar_grafico(sistema, obter_vista(sistema));
+}
+
+void plotar_grafico_funcao_parametrica(Sistema *sistema) {
+    plotar_curva(sistema);
+}
+
+void plotar_grafico_funcao_polar(Sistema *sistema) {
+    plotar_curva(sistema);
+}
+
+void plotar_grafico_selecionado(Sistema *sistema) {
+    switch (sistema->funcao_selecionada) {
+        case FUNCAO_AFIM:
+            plotar_grafico_funcao_afim(sistema);
+            break;
+        case FUNCAO_QUADRATICA:
+            plotar_grafico_funcao_quadratica(sistema);
+            break;
+        case FUNCAO_SENOIDAL:
+            plotar_grafico_funcao_senoidal(sistema);
+            break;
+        case FUNCAO_COSSENOIDAL:
+            plotar_grafico_funcao_cossenoidal(sistema);
+            break;
+        case FUNCAO_PARAMETRICA:
+            plotar_grafico_funcao_parametrica(sistema);
+            break;
+        case FUNCAO_POLAR:
+            plotar_grafico_funcao_polar(sistema);
+            break;
+        default:
+            break;
+    }
+}
+
+// Pré-renderização do gráfico enquanto os parâmetros são editados: cada volta
+// ociosa do laço faz uma etapa (amostras em blocos de colunas, depois camadas
+// e composição num quadro reserva). Se a vista ou os parâmetros mudam no meio,
+// o trabalho recomeça; ao confirmar, um quadro pronto e atual só troca de
+// lugar com o da tela e é enviado.
+#define PRE_RENDER_COLUNAS 32
+#define PRE_RENDER_BLOCOS (SSD1306_LARGURA / PRE_RENDER_COLUNAS)
+#define PRE_RENDER_PRONTO 0xFF
+
+typedef struct {
+    TipoFuncao funcao;
+    float parametros[4];
+    float zoom;
+    float centro_x;
+    float centro_y;
+    float fator_y;
+    bool analise;
+    float analise_inicio;
+    float analise_fim;
+} ChaveGrafico;
+
+static camada_t quadro_reserva;         // Recebe a composição fora da tela
+static ChaveGrafico chave_reserva;      // Dados usados no quadro reserva
+static bool reserva_iniciada = false;
+static uint8_t etapa_reserva;           // Próximo bloco, ou PRE_RENDER_PRONTO
+static bool pre_render_habilitado = true;
+static EstatisticasPreRender pre_render_estatisticas;
+
+static void obter_chave_grafico(const Sistema *sistema, ChaveGrafico *chave) {
+    memset(chave, 0, sizeof(*chave));  // Preenchimento zerado para o memcmp
+    chave->funcao = sistema->funcao_selecionada;
+    memcpy(chave->parametros, sistema->parametros, sizeof(chave->parametros));
+    chave->zoom = sistema->nivel_zoom;
+    chave->centro_x = sistema->posicao_central_x;
+    chave->centro_y = sistema->posicao_central_y;
+    chave->fator_y = sistema->fator_escala_y;
+    chave->analise = sistema->analise.ativa;
+    chave->analise_inicio = sistema->analise.x_inicio;
+    chave->analise_fim = sistema->analise.x_fim;
+}
+
+static bool reserva_atual(const ChaveGrafico *chave) {
+    return reserva_iniciada && memcmp(chave, &chave_reserva, sizeof(*chave)) == 0;
+}
+
+bool pre_renderizacao_pendente(const Sistema *sistema) {
+    if (!pre_render_habilitado || sistema->funcao_selecionada >= TOTAL_FUNCOES) {
+        return false;
+    }
+    ChaveGrafico chave;
+    obter_chave_grafico(sistema, &chave);
+    return !reserva_atual(&chave) || etapa_reserva != PRE_RENDER_PRONTO;
+}
+
+void pre_renderizar_grafico(Sistema *sistema) {
+    if (!pre_renderizacao_pendente(sistema)) {
+        return;
+    }
+
+    ChaveGrafico chave;
+    obter_chave_grafico(sistema, &chave);
+    if (!reserva_atual(&chave)) {
+        // Uma edição mais nova invalida o que já foi feito
+        if (reserva_iniciada && etapa_reserva != PRE_RENDER_PRONTO) {
+            pre_render_estatisticas.cancelados++;
+        }
+        if (quadro_reserva.alvo.ram_buffer == NULL) {
+            camada_init(&quadro_reserva);
         }
+        chave_reserva = chave;
+        reserva_iniciada = true;
+        etapa_reserva = 0;
+    }
+
+    const TransformacaoVista *v = obter_vista(sistema);
+    bool cartesiana = funcao_cartesiana(sistema->funcao_selecionada);
+    if (cartesiana && etapa_reserva < PRE_RENDER_BLOCOS) {
+        uint8_t coluna = etapa_reserva * PRE_RENDER_COLUNAS;
+        cache_amostras_preencher(sistema->funcao_selecionada, sistema->parametros,
+                                 avaliadores[sistema->funcao_selecionada],
+                                 v->x_inicial + coluna * v->passo_x, v->passo_x, 0.5f / v->escala_y,
+                                 sistema->amostras_y + coluna, PRE_RENDER_COLUNAS);
+        etapa_reserva++;
+        return;
     }
 
-    // Desenhar marcadores no eixo Y
-    for (int i = -30; i <= 30; i += espacamento_y) {
-        int y_pos = centro_y - (int)(i * escala_y);  // Ajustado para posição central
-        if (y_pos >= 0 && y_pos < 64) {
-            // Desenhar marcador
-            ssd1306_hline(&sistema->tela, centro_x - 2, centro_x + 2, y_pos, true);
+    camadas_compor(&quadro_reserva.alvo, camadas_grafico, montar_grafico(sistema, v));
+    etapa_reserva = PRE_RENDER_PRONTO;
+    pre_render_estatisticas.concluidos++;
+}
 
-            // Desenhar número a cada 5 unidades até 10, depois de 10 em 10
-            if ((i % 5 == 0 && i <= 10 && i != 0) || (i % 10 == 0 && i > 10)) {
-                char buffer[5];
-                snprintf(buffer, sizeof(buffer), "%d", i);
-                ssd1306_draw_string(&sistema->tela, buffer, centro_x + 4, y_pos - 2, true);
-            }
+// Mostra o gráfico ao confirmar os parâmetros: o quadro reserva troca de
+// lugar com o da tela quando corresponde aos dados atuais; senão o gráfico
+// é desenhado do zero
+void exibir_grafico_preparado(Sistema *sistema) {
+    ChaveGrafico chave;
+    obter_chave_grafico(sistema, &chave);
+    if (!pre_render_habilitado || !reserva_atual(&chave) || etapa_reserva != PRE_RENDER_PRONTO ||
+        escala_cinza_ativa() || sistema->cursor_ativo) {
+        if (pre_render_habilitado) {
+            pre_render_estatisticas.descartados++;
         }
+        plotar_grafico_selecionado(sistema);
+        return;
     }
 
-    // Plotar a função cossenoidal usando mais pontos para suavizar a curva
-    float a = sistema->parametros[0];
-    float b = sistema->parametros[1];
-    float c = sistema->parametros[2];
-    float d = sistema->parametros[3];
+    iniciar_quadro(sistema, ESTADO_EXIBIR_GRAFICO);
+    uint8_t *anterior = sistema->tela.ram_buffer;
+    sistema->tela.ram_buffer = quadro_reserva.alvo.ram_buffer;
+    quadro_reserva.alvo.ram_buffer = anterior;
+    reserva_iniciada = false;  // A reserva agora guarda a tela anterior
+    pre_render_estatisticas.aproveitados++;
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_GRAFICO, sistema->funcao_selecionada);
+
+    enviar_tela(sistema);
+    if (funcao_cartesiana(sistema->funcao_selecionada)) {
+        const TransformacaoVista *v = obter_vista(sistema);
+        transmissao_enviar_amostras(sistema->amostras_y, SSD1306_LARGURA,
+                                    v->x_inicial, v->passo_x);
+    }
+}
 
-    int ultimo_y_pos = -1;
-    for (int px = 0; px < 128; px++) {
-        // Converter coordenada do pixel para coordenada matemática
-        float x_val = (px - centro_x) / escala_x + sistema->posicao_central_x;
+void pre_renderizacao_habilitar(bool habilitar) {
+    pre_render_habilitado = habilitar;
+    reserva_iniciada = false;
+}
+
+bool pre_renderizacao_habilitada(void) {
+    return pre_render_habilitado;
+}
 
-        // Calcular y = a + b * cos(c * x + d)
-        float y_val = a + b * cos(c * x_val + d);
+const EstatisticasPreRender *pre_renderizacao_estatisticas(void) {
+    return &pre_render_estatisticas;
+}
 
-        // Converter coordenada matemática para coordenada do pixel
-        int y_pos = centro_y - (int)(y_val * escala_y);
+void pre_renderizacao_zerar_estatisticas(void) {
+    memset(&pre_render_estatisticas, 0, sizeof(pre_render_estatisticas));
+}
 
-        // Verificar se está dentro dos limites do display
-        if (y_pos >= 0 && y_pos < 64) {
-            ssd1306_pixel(&sistema->tela, px, y_pos, true);
+// Enquadra a curva verticalmente com uma única varredura: as mesmas amostras
+// dão o mínimo e o máximo e depois são desenhadas sem nova avaliação
+void ajustar_vista(Sistema *sistema) {
+    if (!funcao_cartesiana(sistema->funcao_selecionada)) {
+        printf("Vista: ajuste automatico so para y = f(x)\n");
+        return;
+    }
 
-            // Conectar os pontos para uma curva mais suave (linha vertical)
-            if (ultimo_y_pos != -1 && abs(y_pos - ultimo_y_pos) > 1) {
-                int inicio = (ultimo_y_pos < y_pos) ? ultimo_y_pos : y_pos;
-                int fim = (ultimo_y_pos < y_pos) ? y_pos : ultimo_y_pos;
+    parar_animacao(sistema);
+    iniciar_quadro(sistema, ESTADO_EXIBIR_GRAFICO);
 
-                for (int y = inicio; y <= fim; y++) {
-                    if (y >= 0 && y < 64) {
-                        ssd1306_pixel(&sistema->tela, px - 1, y, true);
-                    }
-                }
-            }
+    const TransformacaoVista *v = obter_vista(sistema);
+    amostrar_curva(sistema, v, avaliadores[sistema->funcao_selecionada]);
 
-            ultimo_y_pos = y_pos;
+    float minimo = INFINITY, maximo = -INFINITY;
+    for (int px = 0; px < SSD1306_LARGURA; px++) {
+        float y = sistema->amostras_y[px];
+        if (isfinite(y)) {
+            if (y < minimo) minimo = y;
+            if (y > maximo) maximo = y;
         }
     }
 
-    // Informações sobre o zoom (mantido na parte inferior)
-    char info_zoom[20];
-    snprintf(info_zoom, sizeof(info_zoom), "Zoom: %.1fx", sistema->nivel_zoom);
-    ssd1306_draw_string(&sistema->tela, info_zoom, 0, 55, true);
+    // O vértice da parábola pode cair entre duas colunas
+    const float *p = sistema->parametros;
+    if (sistema->funcao_selecionada == FUNCAO_QUADRATICA && p[0] != 0) {
+        float xv = -p[1] / (2 * p[0]);
+        if (xv >= v->x_inicial && xv <= v->x_inicial + (SSD1306_LARGURA - 1) * v->passo_x) {
+            float yv = avaliar_quadratica(p, xv);
+            if (yv < minimo) minimo = yv;
+            if (yv > maximo) maximo = yv;
+        }
+    }
 
-    // Enviar os dados para o display
-    ssd1306_send_data(&sistema->tela);
+    if (minimo <= maximo) {
+        const float linhas = AJUSTE_LINHA_BASE - AJUSTE_LINHA_TOPO;
+        const float linha_meio = (AJUSTE_LINHA_TOPO + AJUSTE_LINHA_BASE) / 2.0f;
+        float amplitude = maximo - minimo;
+
+        // Curva plana: mantém a escala e apenas centraliza
+        if (amplitude > 1e-6f) {
+            float fator = linhas / amplitude / (0.5f * sistema->nivel_zoom);
+            if (fator < AJUSTE_FATOR_MINIMO) fator = AJUSTE_FATOR_MINIMO;
+            if (fator > AJUSTE_FATOR_MAXIMO) fator = AJUSTE_FATOR_MAXIMO;
+            sistema->fator_escala_y = fator;
+        }
+        float escala_y = 0.5f * sistema->nivel_zoom * sistema->fator_escala_y;
+        sistema->posicao_central_y = (minimo + maximo) / 2 - (CENTRO_Y - linha_meio) / escala_y;
+    }
+
+    // As amostras não dependem da escala vertical: só a transformação é refeita
+    finalizar_grafico(sistema, obter_vista(sistema));
+    printf("Vista: y de %s a %s, escala y %sx, centro y %s\n",
+           texto_decimal(minimo, 3), texto_decimal(maximo, 3), texto_decimal(sistema->fator_escala_y, 3),
+           texto_decimal(sistema->posicao_central_y, 3));
 }
 
+// Volta à escala vertical padrão, com o eixo X no centro da tela
+void restaurar_vista(Sistema *sistema) {
+    sistema->fator_escala_y = 1.0f;
+    sistema->posicao_central_y = 0.0f;
+}
+
+// Força o próximo quadro a refazer o HUD (cursor ou análise trocados por fora)
+void invalidar_hud(void) {
+    hud_valido = false;
+}
+
+// Liga ou desliga o cursor de leitura (exclusivo com animação e tons de cinza,
+// que redesenham o gráfico inteiro a cada quadro)
+bool definir_cursor(Sistema *sistema, bool ativar) {
+    if (ativar == sistema->cursor_ativo) {
+        return ativar;
+    }
+    if (ativar && !funcao_cartesiana(sistema->funcao_selecionada)) {
+        printf("Cursor: so para y = f(x)\n");
+        return false;
+    }
+    if (ativar) {
+        parar_animacao(sistema);
+        definir_escala_cinza(sistema, false);
+        sistema->cursor_coluna = CENTRO_X;
+    }
+    sistema->cursor_ativo = ativar;
+    if (sistema->estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        plotar_grafico_selecionado(sistema);
+    }
+    printf("Cursor: %s\n", ativar ? "ligado" : "desligado");
+    return ativar;
+}
+
+// Liga ou desliga a sobreposição de análise; sem limites definidos, a
+// integral começa na metade central da tela
+bool definir_analise(Sistema *sistema, bool ativar) {
+    if (ativar && !funcao_cartesiana(sistema->funcao_selecionada)) {
+        printf("Analise: so para y = f(x)\n");
+        return false;
+    }
+    if (ativar && sistema->analise.x_inicio == sistema->analise.x_fim) {
+        const TransformacaoVista *v = obter_vista(sistema);
+        sistema->analise.x_inicio = v->x_inicial + (SSD1306_LARGURA / 4) * v->passo_x;
+        sistema->analise.x_fim = v->x_inicial + (SSD1306_LARGURA * 3 / 4) * v->passo_x;
+    }
+    sistema->analise.ativa = ativar;
+    hud_valido = false;
+    if (sistema->estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        plotar_grafico_selecionado(sistema);
+    }
+    printf("Analise: %s\n", ativar ? "ligada" : "desligada");
+    return ativar;
+}
+
+void definir_limites_analise(Sistema *sistema, float x_inicio, float x_fim) {
+    sistema->analise.x_inicio = x_inicio;
+    sistema->analise.x_fim = x_fim;
+}
+
+// Com o cursor ligado, A e B levam o início e o fim da integral até ele
+void marcar_limite_analise(Sistema *sistema, bool fim) {
+    if (!sistema->cursor_ativo) {
+        return;
+    }
+    const TransformacaoVista *v = obter_vista(sistema);
+    float x = v->x_inicial + sistema->cursor_coluna * v->passo_x;
+    if (!sistema->analise.ativa) {
+        // Primeira marca: a área começa vazia, no cursor
+        definir_limites_analise(sistema, x, x);
+        sistema->analise.ativa = true;
+        hud_valido = false;
+    } else if (fim) {
+        sistema->analise.x_fim = x;
+    } else {
+        sistema->analise.x_inicio = x;
+    }
+    plotar_grafico_selecionado(sistema);
+    printf("Analise: integral de %s a %s = %s\n", texto_decimal(sistema->analise.x_inicio, 2),
+           texto_decimal(sistema->analise.x_fim, 2), texto_decimal(sistema->analise.integral, 3));
+}
+
+// Move o cursor sem redesenhar o gráfico: o sprite é apagado e redesenhado
+// com XOR e só as colunas dele e a leitura são enviadas ao display
+void mover_cursor(Sistema *sistema, int16_t colunas) {
+    int nova = sistema->cursor_coluna + colunas;
+    if (nova < 0) nova = 0;
+    if (nova > SSD1306_LARGURA - 1) nova = SSD1306_LARGURA - 1;
+    if (!sistema->cursor_ativo || nova == sistema->cursor_coluna || !funcao_cartesiana(sistema->funcao_selecionada)) {
+        return;
+    }
+
+    iniciar_quadro(sistema, ESTADO_EXIBIR_GRAFICO);
+    int antiga = cursor_coluna_desenhada;
+    uint8_t largura_antiga = leitura_largura;
+    inverter_cursor(sistema, antiga, cursor_linha_desenhada);
+    sistema->cursor_coluna = nova;
+    desenhar_cursor(sistema, obter_vista(sistema));
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_EXIBIR_GRAFICO, sistema->funcao_selecionada);
+
+    uint32_t bytes_antes = sistema->tela.bytes_enviados;
+    rastro_registrar(RASTRO_ENVIO_INICIO, 0, 0);
+    if (abs(nova - antiga) <= 2) {
+        // Sprites sobrepostos: uma janela cobre os dois
+        enviar_colunas_cursor(sistema, (nova < antiga ? nova : antiga) - 1, (nova > antiga ? nova : antiga) + 1);
+    } else {
+        enviar_colunas_cursor(sistema, antiga - 1, antiga + 1);
+        enviar_colunas_cursor(sistema, nova - 1, nova + 1);
+    }
+    uint8_t largura = leitura_largura > largura_antiga ? leitura_largura : largura_antiga;
+    if (largura > 0) {
+        ssd1306_send_janela(&sistema->tela, LEITURA_PAGINA, LEITURA_PAGINA + 1, 0, largura - 1);
+    }
+    rastro_registrar(RASTRO_ENVIO_FIM, 0, sistema->tela.bytes_enviados - bytes_antes);
+    transmissao_enviar_tela(&sistema->tela);
+    sessao_contar_quadro(time_us_32() - inicio_quadro_us);
+}
+
+// Última troca pelo joystick: o agendador acorda o laço a cada 20 ms enquanto
+// o joystick está fora do centro, e a repetição espera o intervalo sem bloquear
+static absolute_time_t ultima_troca_menu;
+static absolute_time_t ultimo_zoom_grafico;
+
 void gerenciar_estado_menu(Sistema *sistema) {
-    adc_select_input(0);
-    uint16_t leitura_y = adc_read();
+    uint16_t leitura_y = sessao_ler_adc(0);
+    rastro_registrar(RASTRO_ADC, 0, leitura_y);
     int16_t diferenca = (int16_t)leitura_y - 2048;
 
     if (abs(diferenca) > ZONA_MORTA) {
+        if (absolute_time_diff_us(ultima_troca_menu, get_absolute_time()) < INTERVALO_MENU_MS * 1000) {
+            return;
+        }
+        ultima_troca_menu = get_absolute_time();
         if (diferenca > 0) {
             mostrar_seta(true);  // Seta para cima
         } else {
@@ -525,107 +1417,408 @@ void gerenciar_estado_menu(Sistema *sistema) {
         }
         desenhar_tela_menu(sistema);
         atualizar_cores_rgb();
-        sleep_ms(200);
     } else {
         desligar_matriz();  // Desligar a matriz se o joystick estiver na posição neutra
     }
 }
 
-void gerenciar_estado_grafico(Sistema *sistema) {
-    adc_select_input(0);
-    uint16_t leitura_y = adc_read();
+// Lê o joystick e ajusta o zoom; retorna true se o zoom mudou
+static bool ajustar_zoom(Sistema *sistema) {
+    uint16_t leitura_y = sessao_ler_adc(0);
+    rastro_registrar(RASTRO_ADC, 0, leitura_y);
     int16_t diferenca = (int16_t)leitura_y - 2048;
 
-    if (abs(diferenca) > ZONA_MORTA) {
-        if (diferenca > 0) {  // Joystick para cima
-            sistema->nivel_zoom *= 1.1;  // Aumentar o zoom
-        } else {  // Joystick para baixo
-            sistema->nivel_zoom /= 1.1;  // Diminuir o zoom
+    if (abs(diferenca) <= ZONA_MORTA) {
+        return false;
+    }
+
+    if (diferenca > 0) {  // Joystick para cima
+        sistema->nivel_zoom *= 1.1;  // Aumentar o zoom
+    } else {  // Joystick para baixo
+        sistema->nivel_zoom /= 1.1;  // Diminuir o zoom
+    }
+
+    // Limitar o zoom para evitar valores extremos
+    if (sistema->nivel_zoom < 0.1) sistema->nivel_zoom = 0.1;
+    if (sistema->nivel_zoom > 10.0) sistema->nivel_zoom = 10.0;
+
+    atualizar_brilho_zoom();
+    return true;
+}
+
+static void relatar_animacao(Sistema *sistema) {
+    RitmoQuadros *ritmo = &sistema->animacao.ritmo;
+    unsigned media_us = ritmo->quadros ? (unsigned)(ritmo->duracao_total_us / ritmo->quadros) : 0;
+
+    printf("Animacao: %u quadros, %u descartados, render+envio medio %u us, max %u us (orcamento %u us)\n",
+           (unsigned)ritmo->quadros, (unsigned)ritmo->descartados, media_us,
+           (unsigned)ritmo->duracao_max_us, (unsigned)ritmo->periodo_us);
+    if (ritmo->estouros > 0 || ritmo->descartados > 0) {
+        printf("Animacao: %u fps nao sustentados (%u quadros acima do orcamento)\n",
+               ANIMACAO_FPS, (unsigned)ritmo->estouros);
+    }
+    ritmo_zerar_estatisticas(ritmo);
+}
+
+// Um quadro da animação: espera o prazo, avança o parâmetro e redesenha
+static void animar_grafico(Sistema *sistema) {
+    Animacao *animacao = &sistema->animacao;
+    uint32_t periodos = ritmo_aguardar_quadro(&animacao->ritmo);
+
+    uint32_t inicio = time_us_32();
+
+    if (absolute_time_diff_us(animacao->ultimo_zoom, get_absolute_time()) >= INTERVALO_ZOOM_MS * 1000 &&
+        ajustar_zoom(sistema)) {
+        animacao->ultimo_zoom = get_absolute_time();
+    }
+
+    // Quadros descartados também avançam a varredura para manter a velocidade
+    float faixa = animacao->maximo - animacao->minimo;
+    float valor = sistema->parametros[animacao->indice_parametro] + animacao->passo * periodos;
+    if (animacao->circular) {
+        while (valor >= animacao->maximo) valor -= faixa;
+    } else if (valor > animacao->maximo) {
+        valor = 2 * animacao->maximo - valor;
+        animacao->passo = -animacao->passo;
+    } else if (valor < animacao->minimo) {
+        valor = 2 * animacao->minimo - valor;
+        animacao->passo = -animacao->passo;
+    }
+    sistema->parametros[animacao->indice_parametro] = valor;
+
+    plotar_grafico_selecionado(sistema);
+    ritmo_registrar_quadro(&animacao->ritmo, time_us_32() - inicio);
+
+    if (absolute_time_diff_us(animacao->inicio_relatorio, get_absolute_time()) >= ANIMACAO_RELATORIO_MS * 1000) {
+        relatar_animacao(sistema);
+        animacao->inicio_relatorio = get_absolute_time();
+    }
+}
+
+void gerenciar_estado_grafico(Sistema *sistema) {
+    if (sistema->animacao.ativa) {
+        animar_grafico(sistema);
+        return;
+    }
+
+    if (sistema->cursor_ativo) {
+        // O joystick passa a mover o cursor: para cima anda para a direita
+        uint16_t leitura_y = sessao_ler_adc(0);
+        rastro_registrar(RASTRO_ADC, 0, leitura_y);
+        int16_t diferenca = (int16_t)leitura_y - 2048;
+        if (abs(diferenca) > ZONA_MORTA) {
+            int16_t passo = abs(diferenca) > CURSOR_LIMIAR_RAPIDO ? CURSOR_PASSO_RAPIDO : 1;
+            mover_cursor(sistema, diferenca > 0 ? passo : -passo);
+        }
+        return;
+    }
+
+    // Sem bloquear: subquadros de cinza, comandos e botões seguem no ritmo
+    if (absolute_time_diff_us(ultimo_zoom_grafico, get_absolute_time()) >= INTERVALO_ZOOM_MS * 1000 &&
+        ajustar_zoom(sistema)) {
+        ultimo_zoom_grafico = get_absolute_time();
+        plotar_grafico_selecionado(sistema);
+    }
+}
+
+// Osciloscópio: a captura (osciloscopio.c) entrega quadros já reduzidos a
+// mínimo e máximo por coluna; aqui eles viram a forma de onda nas mesmas
+// camadas do gráfico, com x em milissegundos a partir do gatilho e y em
+// volts. O joystick muda a base de tempo com o mesmo zoom das funções.
+static TransformacaoVista vista_osciloscopio;
+static float eixos_osciloscopio_escala = -1.0f;  // Escala x dos eixos já desenhados
+static const QuadroOsciloscopio *quadro_exibido = NULL;
+static bool osciloscopio_congelado = false;
+static absolute_time_t ultimo_zoom_osciloscopio;
+
+static int linha_da_leitura(const TransformacaoVista *v, uint16_t leitura) {
+    float volts = leitura * (OSC_TENSAO_REFERENCIA / (OSC_NIVEL_MAXIMO + 1));
+    return linha_limitada(v, volts);
+}
+
+// Colunas por amostra para a taxa atual e o zoom; vale a partir do próximo quadro
+static void aplicar_base_tempo(Sistema *sistema) {
+    float pixels_por_ms = sistema->nivel_zoom * OSC_PIXELS_POR_MS;
+    osciloscopio_definir_colunas_por_amostra(pixels_por_ms * 1000.0f / osciloscopio_taxa());
+}
+
+static void desenhar_hud_osciloscopio(Sistema *sistema, const TransformacaoVista *v) {
+    ssd1306_t *alvo = &camada_hud.alvo;
+    camada_limpar(&camada_hud);
+
+    // Tempo na largura da tela à esquerda; borda e nível do gatilho à direita
+    char buffer[12];
+    const char *fim = buffer + sizeof(buffer);
+    texto_anexar(texto_numero(buffer, fim, SSD1306_LARGURA * v->passo_x, 2, 0), fim, "ms");
+    ssd1306_draw_string(alvo, buffer, 4, 0, true);
+
+    const char bordas[TOTAL_GATILHOS] = {'S', 'D', 'L'};
+    char *texto = buffer;
+    if (osciloscopio_congelado) {
+        texto = texto_anexar(texto, fim, "P ");
+    }
+    texto[0] = bordas[osciloscopio_borda()];
+    texto[1] = '\0';
+    texto_numero(texto + 1, fim, osciloscopio_nivel() * (OSC_TENSAO_REFERENCIA / (OSC_NIVEL_MAXIMO + 1)), 2, 0);
+    ssd1306_draw_string(alvo, buffer, SSD1306_LARGURA - largura_rotulo(buffer), 0, true);
+}
+
+static void desenhar_osciloscopio(Sistema *sistema) {
+    const QuadroOsciloscopio *quadro = quadro_exibido;
+    iniciar_quadro(sistema, ESTADO_OSCILOSCOPIO);
+
+    // A escala x vem da base de tempo com que o quadro foi capturado
+    TransformacaoVista *v = &vista_osciloscopio;
+    float escala_x = quadro != NULL ?
+        quadro->colunas_por_amostra_q16 / 65536.0f * quadro->taxa / 1000.0f :
+        sistema->nivel_zoom * OSC_PIXELS_POR_MS;
+    v->escala_x = escala_x;
+    v->passo_x = 1.0f / escala_x;
+    v->x_inicial = 0.0f;
+    v->coluna_zero = 0.0f;
+    v->escala_y = OSC_PIXELS_POR_VOLT;
+    v->linha_zero = OSC_LINHA_ZERO_VOLT;
+    if (eixos_osciloscopio_escala != escala_x) {
+        desenhar_eixos(v);
+        eixos_osciloscopio_escala = escala_x;
+        eixos_validos = false;  // A camada deixa de ter os eixos das funções
+    }
+
+    // Faixa de cada coluna, estendida até a anterior para a onda não ter falhas
+    camada_limpar(&camada_curva);
+    if (quadro != NULL) {
+        int anterior_topo = -1;
+        int anterior_base = -1;
+        for (uint8_t coluna = 0; coluna < OSC_COLUNAS; coluna++) {
+            int topo = linha_da_leitura(v, quadro->maximo[coluna]);
+            int base = linha_da_leitura(v, quadro->minimo[coluna]);
+            if (anterior_topo >= 0) {
+                if (topo > anterior_base) topo = anterior_base;
+                if (base < anterior_topo) base = anterior_topo;
+            }
+            ssd1306_vline(&camada_curva.alvo, coluna, (uint8_t)topo, (uint8_t)base, true);
+            anterior_topo = topo;
+            anterior_base = base;
         }
+    }
 
-        // Limitar o zoom para evitar valores extremos
-        if (sistema->nivel_zoom < 0.1) sistema->nivel_zoom = 0.1;
-        if (sistema->nivel_zoom > 10.0) sistema->nivel_zoom = 10.0;
-
-        atualizar_brilho_zoom();
-
-        switch (sistema->funcao_selecionada) {
-            case FUNCAO_AFIM:
-                plotar_grafico_funcao_afim(sistema);
-                break;
-            case FUNCAO_QUADRATICA:
-                plotar_grafico_funcao_quadratica(sistema);
-                break;
-            case FUNCAO_SENOIDAL:
-                plotar_grafico_funcao_senoidal(sistema);
-                break;
-            case FUNCAO_COSSENOIDAL:
-                plotar_grafico_funcao_cossenoidal(sistema);
-                break;
+    // Nível do gatilho tracejado na camada da análise
+    camada_limpar(&camada_analise);
+    if (osciloscopio_borda() != GATILHO_LIVRE) {
+        uint8_t linha = (uint8_t)linha_da_leitura(v, osciloscopio_nivel());
+        for (uint8_t x = 0; x < SSD1306_LARGURA; x += 2 * ANALISE_TRACO) {
+            ssd1306_hline(&camada_analise.alvo, x, x + ANALISE_TRACO - 1, linha, true);
         }
-        sleep_ms(200);
     }
+
+    desenhar_hud_osciloscopio(sistema, v);
+    hud_valido = false;  // Idem para o HUD
+
+    rastro_registrar(RASTRO_RENDER_FIM, ESTADO_OSCILOSCOPIO, 0);
+    camadas_compor(&sistema->tela, camadas_grafico, 4);
+    enviar_tela(sistema);
 }
 
-void atualizar_cores_rgb() {
-    // Obter o canal correto para cada pino
-    uint channel_vermelho = pwm_gpio_to_channel(PINO_RGB_VERMELHO);
-    uint channel_verde = pwm_gpio_to_channel(PINO_RGB_VERDE);
-    uint channel_azul = pwm_gpio_to_channel(PINO_RGB_AZUL);
+void iniciar_osciloscopio(Sistema *sistema) {
+    parar_animacao(sistema);
+    definir_estado(sistema, ESTADO_OSCILOSCOPIO);
+    if (!osciloscopio_iniciar(osciloscopio_canal(), CANAL_JOYSTICK)) {
+        printf("Osciloscopio: sem canais DMA livres\n");
+        definir_estado(sistema, ESTADO_MENU);
+        desenhar_tela_menu(sistema);
+        return;
+    }
+    aplicar_base_tempo(sistema);
+    quadro_exibido = NULL;
+    osciloscopio_congelado = false;
+    eixos_osciloscopio_escala = -1.0f;
+    desenhar_osciloscopio(sistema);
+    printf("Osciloscopio: canal %u, %u amostras/s\n", osciloscopio_canal(), (unsigned)osciloscopio_taxa());
+}
 
-    uint slice_vermelho = pwm_gpio_to_slice_num(PINO_RGB_VERMELHO);
-    uint slice_verde = pwm_gpio_to_slice_num(PINO_RGB_VERDE);
-    uint slice_azul = pwm_gpio_to_slice_num(PINO_RGB_AZUL);
+// Zoom pelo joystick (a leitura vem da própria captura) e o quadro mais novo
+void gerenciar_estado_osciloscopio(Sistema *sistema) {
+    if (!osciloscopio_congelado &&
+        absolute_time_diff_us(ultimo_zoom_osciloscopio, get_absolute_time()) >= INTERVALO_ZOOM_MS * 1000 &&
+        ajustar_zoom(sistema)) {
+        ultimo_zoom_osciloscopio = get_absolute_time();
+    }
+    aplicar_base_tempo(sistema);
 
-    switch (sistema.funcao_selecionada) {
-        case FUNCAO_AFIM:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, 255);
-            pwm_set_chan_level(slice_verde, channel_verde, 0);
-            pwm_set_chan_level(slice_azul, channel_azul, 0);
-            break;
-        case FUNCAO_QUADRATICA:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, 0);
-            pwm_set_chan_level(slice_verde, channel_verde, 255);
-            pwm_set_chan_level(slice_azul, channel_azul, 0);
-            break;
-        case FUNCAO_SENOIDAL:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, 0);
-            pwm_set_chan_level(slice_verde, channel_verde, 0);
-            pwm_set_chan_level(slice_azul, channel_azul, 255);
-            break;
-        case FUNCAO_COSSENOIDAL:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, 255);
-            pwm_set_chan_level(slice_verde, channel_verde, 255);
-            pwm_set_chan_level(slice_azul, channel_azul, 255);
-            break;
+    if (osciloscopio_congelado) {
+        return;
+    }
+    const QuadroOsciloscopio *quadro = osciloscopio_obter_quadro();
+    if (quadro != NULL) {
+        quadro_exibido = quadro;
+        desenhar_osciloscopio(sistema);
     }
 }
 
-void atualizar_brilho_zoom() {
-    uint channel_vermelho = pwm_gpio_to_channel(PINO_RGB_VERMELHO);
-    uint channel_verde = pwm_gpio_to_channel(PINO_RGB_VERDE);
-    uint channel_azul = pwm_gpio_to_channel(PINO_RGB_AZUL);
+// Borda do gatilho: subida, descida e livre
+void alternar_borda_osciloscopio(Sistema *sistema) {
+    BordaGatilho borda = (BordaGatilho)((osciloscopio_borda() + 1) % TOTAL_GATILHOS);
+    osciloscopio_definir_gatilho(borda, osciloscopio_nivel());
+    desenhar_osciloscopio(sistema);
+}
+
+// Nível do gatilho no meio da faixa do quadro exibido
+void ajustar_nivel_osciloscopio(Sistema *sistema) {
+    if (quadro_exibido == NULL) {
+        return;
+    }
+    uint16_t minimo = OSC_NIVEL_MAXIMO, maximo = 0;
+    for (uint8_t coluna = 0; coluna < OSC_COLUNAS; coluna++) {
+        if (quadro_exibido->minimo[coluna] < minimo) minimo = quadro_exibido->minimo[coluna];
+        if (quadro_exibido->maximo[coluna] > maximo) maximo = quadro_exibido->maximo[coluna];
+    }
+    osciloscopio_definir_gatilho(osciloscopio_borda(), (uint16_t)((minimo + maximo) / 2));
+    desenhar_osciloscopio(sistema);
+}
 
-    uint slice_vermelho = pwm_gpio_to_slice_num(PINO_RGB_VERMELHO);
-    uint slice_verde = pwm_gpio_to_slice_num(PINO_RGB_VERDE);
-    uint slice_azul = pwm_gpio_to_slice_num(PINO_RGB_AZUL);
+// Congela o quadro exibido; a captura continua e o próximo quadro aparece ao soltar
+void alternar_congelamento_osciloscopio(Sistema *sistema) {
+    osciloscopio_congelado = !osciloscopio_congelado;
+    desenhar_osciloscopio(sistema);
+}
 
-    uint8_t brilho = (uint8_t)(25.5 * sistema.nivel_zoom);
+// Define a faixa e o passo da varredura do parâmetro escolhido
+static void configurar_varredura(Sistema *sistema) {
+    Animacao *animacao = &sistema->animacao;
+    bool senoide = sistema->funcao_selecionada == FUNCAO_SENOIDAL ||
+                   sistema->funcao_selecionada == FUNCAO_COSSENOIDAL ||
+                   !funcao_cartesiana(sistema->funcao_selecionada);
+
+    animacao->valor_original = sistema->parametros[animacao->indice_parametro];
+    if (senoide && animacao->indice_parametro == 3) {
+        // Fase D: percorre um período completo
+        animacao->minimo = 0.0f;
+        animacao->maximo = 2.0f * (float)M_PI;
+        animacao->circular = true;
+    } else {
+        animacao->minimo = animacao->valor_original - ANIMACAO_AMPLITUDE;
+        animacao->maximo = animacao->valor_original + ANIMACAO_AMPLITUDE;
+        animacao->circular = false;
+    }
+    animacao->passo = (animacao->maximo - animacao->minimo) * animacao->ritmo.periodo_us /
+                      (ANIMACAO_DURACAO_MS * 1000.0f);
+}
 
-    switch (sistema.funcao_selecionada) {
-        case FUNCAO_AFIM:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, brilho);
-            break;
-        case FUNCAO_QUADRATICA:
-            pwm_set_chan_level(slice_verde, channel_verde, brilho);
-            break;
-        case FUNCAO_SENOIDAL:
-            pwm_set_chan_level(slice_azul, channel_azul, brilho);
-            break;
-        case FUNCAO_COSSENOIDAL:
-            pwm_set_chan_level(slice_vermelho, channel_vermelho, brilho);
-            pwm_set_chan_level(slice_verde, channel_verde, brilho);
-            pwm_set_chan_level(slice_azul, channel_azul, brilho);
-            break;
+void alternar_animacao(Sistema *sistema) {
+    Animacao *animacao = &sistema->animacao;
+
+    if (animacao->ativa) {
+        parar_animacao(sistema);
+        plotar_grafico_selecionado(sistema);
+        return;
+    }
+
+    // A espera entre quadros da animação travaria os subquadros de cinza, e
+    // cada quadro redesenharia o cursor
+    definir_escala_cinza(sistema, false);
+    definir_cursor(sistema, false);
+
+    if (animacao->indice_parametro >= parametros_por_funcao[sistema->funcao_selecionada]) {
+        animacao->indice_parametro = 0;
+    }
+    ritmo_iniciar(&animacao->ritmo, ANIMACAO_FPS);
+    configurar_varredura(sistema);
+    animacao->inicio_relatorio = get_absolute_time();
+    animacao->ultimo_zoom = animacao->inicio_relatorio;
+    animacao->ativa = true;
+    atualizar_brilho_zoom();
+}
+
+void selecionar_parametro_animacao(Sistema *sistema) {
+    Animacao *animacao = &sistema->animacao;
+
+    if (animacao->ativa) {
+        sistema->parametros[animacao->indice_parametro] = animacao->valor_original;
+    }
+    animacao->indice_parametro = (animacao->indice_parametro + 1) % parametros_por_funcao[sistema->funcao_selecionada];
+    if (animacao->ativa) {
+        configurar_varredura(sistema);
+    }
+    printf("Animacao: parametro %c\n", 'A' + animacao->indice_parametro);
+}
+
+void parar_animacao(Sistema *sistema) {
+    Animacao *animacao = &sistema->animacao;
+
+    if (!animacao->ativa) {
+        return;
+    }
+    animacao->ativa = false;
+    sistema->parametros[animacao->indice_parametro] = animacao->valor_original;
+    hud_valido = false;
+    atualizar_brilho_zoom();
+}
+
+// Liga ou desliga os tons de cinza; retorna o estado resultante. Ao ligar, o
+// modo só é mantido se os subquadros couberem no orçamento de tempo.
+bool definir_escala_cinza(Sistema *sistema, bool ativar) {
+    if (ativar == escala_cinza_ativa()) {
+        return ativar;
+    }
+
+    if (!ativar) {
+        escala_cinza_desativar(&sistema->tela);
+        i2c_set_baudrate(sistema->tela.i2c_port, I2C_FREQUENCIA_HZ);
+        if (sistema->estado_atual == ESTADO_EXIBIR_GRAFICO) {
+            plotar_grafico_selecionado(sistema);
+        }
+        return false;
+    }
+
+    parar_animacao(sistema);
+    sistema->cursor_ativo = false;  // O cursor usa XOR sobre a tela monocromática
+    i2c_set_baudrate(sistema->tela.i2c_port, I2C_FREQUENCIA_CINZA_HZ);
+    escala_cinza_ativar(&sistema->tela);
+    plotar_grafico_selecionado(sistema);
+
+    if (!escala_cinza_verificar_orcamento(&sistema->tela)) {
+        definir_escala_cinza(sistema, false);
+        return false;
+    }
+    ultimo_zoom_grafico = get_absolute_time();
+    return true;
+}
+
+// Envia o próximo subquadro; se o orçamento estourar, volta ao monocromático
+void atualizar_escala_cinza(Sistema *sistema) {
+    if (escala_cinza_ativa() && !escala_cinza_atualizar(&sistema->tela)) {
+        i2c_set_baudrate(sistema->tela.i2c_port, I2C_FREQUENCIA_HZ);
+        plotar_grafico_selecionado(sistema);
+    }
+}
+
+// Cor do LED RGB de cada função, em intensidade perceptual
+static const CorRgb cores_funcoes[TOTAL_FUNCOES] = {
+    {255, 0, 0},        // Afim: vermelho
+    {0, 255, 0},        // Quadrática: verde
+    {0, 0, 255},        // Senoidal: azul
+    {255, 255, 255},    // Cossenoidal: branco
+    {255, 0, 255},      // Paramétrica: magenta
+    {0, 255, 255},      // Polar: ciano
+};
+
+void atualizar_cores_rgb() {
+    led_rgb_definir(cores_funcoes[sistema.funcao_selecionada], LED_TRANSICAO_MS);
+}
+
+// Brilho proporcional ao zoom (10x = máximo); durante a animação o LED respira
+void atualizar_brilho_zoom() {
+    float brilho = 25.5f * sistema.nivel_zoom;
+    if (brilho > 255.0f) brilho = 255.0f;  // Acima de 10x o uint8_t dava a volta
+    uint8_t fator = (uint8_t)brilho;
+
+    CorRgb cor = cores_funcoes[sistema.funcao_selecionada];
+    cor.r = cor.r * fator / 255;
+    cor.g = cor.g * fator / 255;
+    cor.b = cor.b * fator / 255;
+    if (sistema.animacao.ativa) {
+        led_rgb_respirar(cor, LED_RESPIRACAO_MS);
+    } else {
+        led_rgb_definir(cor, LED_TRANSICAO_MS);
     }
 }
@@ -6,6 +6,12 @@
 #include "hardware/pwm.h"
 #include "Display_Bibliotecas/ssd1306.h"
 #include "Matriz_Bibliotecas/matriz_led.h"
+#include "ritmo_quadros.h"
+
+// Segundo SSD1306 no i2c0 com parâmetros e leituras (opção SEGUNDA_TELA do CMake)
+#ifndef SEGUNDA_TELA_ATIVA
+#define SEGUNDA_TELA_ATIVA 0
+#endif
 
 // Tipos de função
 typedef enum {
@@ -13,6 +19,8 @@ typedef enum {
     FUNCAO_QUADRATICA,
     FUNCAO_SENOIDAL,
     FUNCAO_COSSENOIDAL,
+    FUNCAO_PARAMETRICA,
+    FUNCAO_POLAR,
     TOTAL_FUNCOES
 } TipoFuncao;
 
@@ -21,32 +29,136 @@ typedef enum {
     ESTADO_MENU,
     ESTADO_CONFIGURAR_PARAMETROS,
     ESTADO_EXIBIR_GRAFICO,
-    ESTADO_EXIBIR_VALORES
+    ESTADO_EXIBIR_VALORES,
+    ESTADO_EXIBIR_TABELA,
+    ESTADO_OSCILOSCOPIO
 } EstadoSistema;
 
+// Animação que varre um parâmetro enquanto o gráfico é exibido
+typedef struct {
+    bool ativa;
+    uint8_t indice_parametro;   // Parâmetro varrido (0 = A ... 3 = D)
+    float valor_original;       // Valor restaurado ao final da animação
+    float minimo;               // Faixa da varredura
+    float maximo;
+    float passo;                // Variação por quadro (o sinal indica o sentido)
+    bool circular;              // Fase: volta ao início em vez de inverter
+    RitmoQuadros ritmo;
+    absolute_time_t inicio_relatorio;
+    absolute_time_t ultimo_zoom;
+} Animacao;
+
+// Tabela de valores rolável: a linha r mostra x = x_inicial + r * passo
+#define TABELA_TOTAL_PASSOS 9
+#define TABELA_PASSO_PADRAO 5           // Passo 1
+
+typedef struct {
+    float x_inicial;
+    float passo;
+    uint8_t indice_passo;       // Posição na lista de passos
+    int32_t primeira_linha;     // Linha exibida no topo
+    uint32_t avaliacoes;        // Linhas avaliadas desde o início (cada uma só ao entrar na tela)
+} TabelaValores;
+
+// Sobreposição de análise: derivada tracejada e área da integral entre dois
+// limites, calculadas na mesma varredura das amostras da curva
+typedef struct {
+    bool ativa;
+    float x_inicio;             // Limites da integral (em qualquer ordem)
+    float x_fim;
+    float integral;             // Resultado da última varredura
+    bool aproximada;            // Parte fora da tela somada com passo maior que o da tela
+} Analise;
+
+// Transformação afim entre pixels e coordenadas do gráfico, recalculada
+// apenas quando a vista muda: x = x_inicial + coluna * passo_x e
+// linha = linha_zero - y * escala_y
+typedef struct {
+    float escala_x;       // Pixels por unidade no eixo X
+    float escala_y;       // Pixels por unidade no eixo Y
+    float passo_x;        // Unidades por coluna (1 / escala_x)
+    float x_inicial;      // Valor de x na coluna 0
+    float coluna_zero;    // Coluna de x = 0 (pode estar fora da tela)
+    float linha_zero;     // Linha de y = 0 (pode estar fora da tela)
+} TransformacaoVista;
+
 // Estrutura de dados do sistema
 typedef struct {
     ssd1306_t tela;
+#if SEGUNDA_TELA_ATIVA
+    ssd1306_t painel_dados;     // Parâmetros, valores e análise no segundo display
+#endif
     EstadoSistema estado_atual;
     TipoFuncao funcao_selecionada;
     float parametros[4];  // A, B, C, D (dependendo da função)
     uint8_t indice_parametro_atual;
-    absolute_time_t tempo_ultimo_botao;
     float nivel_zoom;           // Nível de zoom
     float posicao_central_x;    // Posição central do gráfico no eixo X
+    float posicao_central_y;    // Valor de y exibido no centro vertical da tela
+    float fator_escala_y;       // Escala do eixo Y relativa à do X (1 = metade do zoom)
+    Animacao animacao;
+    bool cursor_ativo;          // Modo de leitura: o joystick move o cursor pela curva
+    uint8_t cursor_coluna;      // Coluna do cursor
+    TabelaValores tabela;
+    Analise analise;
+    float amostras_y[SSD1306_LARGURA];  // Valores de y da última curva, um por coluna
 } Sistema;
 
+// Contadores da pré-renderização do gráfico durante a configuração
+typedef struct {
+    uint32_t concluidos;   // Quadros reserva completados
+    uint32_t cancelados;   // Quadros interrompidos por uma edição mais nova
+    uint32_t aproveitados; // Confirmações atendidas só com a troca de buffers
+    uint32_t descartados;  // Confirmações que precisaram desenhar do zero
+} EstatisticasPreRender;
+
 // Protótipos das funções
 void inicializar_sistema(Sistema *sistema);
+void exibir_primeiro_quadro(Sistema *sistema);
 void desenhar_tela_menu(Sistema *sistema);
 void desenhar_tela_configuracao_parametros(Sistema *sistema);
 void plotar_grafico_funcao_afim(Sistema *sistema);
 void plotar_grafico_funcao_quadratica(Sistema *sistema);
 void plotar_grafico_funcao_senoidal(Sistema *sistema);
 void plotar_grafico_funcao_cossenoidal(Sistema *sistema);
+void plotar_grafico_funcao_parametrica(Sistema *sistema);
+void plotar_grafico_funcao_polar(Sistema *sistema);
+bool funcao_cartesiana(TipoFuncao funcao);
+void plotar_grafico_selecionado(Sistema *sistema);
+bool pre_renderizacao_pendente(const Sistema *sistema);
+void pre_renderizar_grafico(Sistema *sistema);
+void exibir_grafico_preparado(Sistema *sistema);
+void pre_renderizacao_habilitar(bool habilitar);
+bool pre_renderizacao_habilitada(void);
+const EstatisticasPreRender *pre_renderizacao_estatisticas(void);
+void pre_renderizacao_zerar_estatisticas(void);
+void ajustar_vista(Sistema *sistema);
+void restaurar_vista(Sistema *sistema);
+void invalidar_hud(void);
+bool definir_cursor(Sistema *sistema, bool ativar);
+void mover_cursor(Sistema *sistema, int16_t colunas);
+bool definir_analise(Sistema *sistema, bool ativar);
+void definir_limites_analise(Sistema *sistema, float x_inicio, float x_fim);
+void marcar_limite_analise(Sistema *sistema, bool fim);
 void desenhar_tela_valores_quadratica(Sistema *sistema);
+void definir_estado(Sistema *sistema, EstadoSistema estado);
+void iniciar_tabela(Sistema *sistema);
+void desenhar_tela_tabela(Sistema *sistema);
+void rolar_tabela(Sistema *sistema, int32_t linhas);
+void alterar_passo_tabela(Sistema *sistema, int8_t sentido);
+void gerenciar_estado_tabela(Sistema *sistema);
 void gerenciar_estado_menu(Sistema *sistema);
 void gerenciar_estado_grafico(Sistema *sistema);
+void alternar_animacao(Sistema *sistema);
+void selecionar_parametro_animacao(Sistema *sistema);
+void parar_animacao(Sistema *sistema);
+void iniciar_osciloscopio(Sistema *sistema);
+void gerenciar_estado_osciloscopio(Sistema *sistema);
+void alternar_borda_osciloscopio(Sistema *sistema);
+void ajustar_nivel_osciloscopio(Sistema *sistema);
+void alternar_congelamento_osciloscopio(Sistema *sistema);
+bool definir_escala_cinza(Sistema *sistema, bool ativar);
+void atualizar_escala_cinza(Sistema *sistema);
 void atualizar_cores_rgb();
 void atualizar_brilho_zoom();
 
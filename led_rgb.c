@@ -0,0 +1,193 @@
+#include "led_rgb.h"
+#include "hardware/pwm.h"
+#include "hardware/irq.h"
+#include "hardware/clocks.h"
+
+// Intensidade perceptual (0 a 255) -> nível do PWM, gama 2,2
+static const uint16_t gama[256] = {
+       0,    1,    1,    1,    1,    1,    1,    2,    2,    3,    3,    4,
+       5,    6,    7,    8,    9,   11,   12,   14,   15,   17,   19,   21,
+      23,   25,   27,   29,   32,   34,   37,   40,   43,   46,   49,   52,
+      55,   59,   62,   66,   70,   73,   77,   82,   86,   90,   95,   99,
+     104,  109,  114,  119,  124,  129,  135,  140,  146,  152,  158,  164,
+     170,  176,  182,  189,  196,  202,  209,  216,  224,  231,  238,  246,
+     254,  261,  269,  277,  286,  294,  302,  311,  320,  328,  337,  347,
+     356,  365,  375,  384,  394,  404,  414,  424,  435,  445,  456,  467,
+     477,  488,  500,  511,  522,  534,  545,  557,  569,  581,  594,  606,
+     619,  631,  644,  657,  670,  683,  697,  710,  724,  738,  752,  766,
+     780,  794,  809,  823,  838,  853,  868,  884,  899,  914,  930,  946,
+     962,  978,  994, 1011, 1027, 1044, 1061, 1078, 1095, 1112, 1130, 1147,
+    1165, 1183, 1201, 1219, 1237, 1256, 1274, 1293, 1312, 1331, 1350, 1370,
+    1389, 1409, 1429, 1449, 1469, 1489, 1509, 1530, 1551, 1572, 1593, 1614,
+    1635, 1657, 1678, 1700, 1722, 1744, 1766, 1789, 1811, 1834, 1857, 1880,
+    1903, 1926, 1950, 1974, 1997, 2021, 2045, 2070, 2094, 2119, 2143, 2168,
+    2193, 2219, 2244, 2270, 2295, 2321, 2347, 2373, 2400, 2426, 2453, 2479,
+    2506, 2534, 2561, 2588, 2616, 2644, 2671, 2700, 2728, 2756, 2785, 2813,
+    2842, 2871, 2900, 2930, 2959, 2989, 3019, 3049, 3079, 3109, 3140, 3170,
+    3201, 3232, 3263, 3295, 3326, 3358, 3390, 3421, 3454, 3486, 3518, 3551,
+    3584, 3617, 3650, 3683, 3716, 3750, 3784, 3818, 3852, 3886, 3920, 3955,
+    3990, 4025, 4060, 4095
+};
+
+typedef enum {
+    EFEITO_FIXO,
+    EFEITO_TRANSICAO,
+    EFEITO_RESPIRAR,
+    EFEITO_PISCAR
+} TipoEfeito;
+
+// Slice e canal de cada cor, calculados uma vez na inicialização
+typedef struct {
+    uint slice;
+    uint canal;
+} SaidaPwm;
+
+static SaidaPwm saidas[3];
+static uint slice_interrupcao;
+
+// Efeito em andamento; alterado com a interrupção do slice desligada
+static volatile TipoEfeito tipo = EFEITO_FIXO;
+static uint8_t origem[3];
+static uint8_t destino[3];
+static uint8_t atual[3];
+static uint32_t tempo_ms;
+static uint32_t duracao_ms;
+
+static bool suspenso = false;
+static bool sinal_envio = false;
+static bool enviando_quadro = false;
+
+static void escrever_niveis(void) {
+    for (uint8_t i = 0; i < 3; i++) {
+        uint16_t nivel = suspenso ? 0 : gama[enviando_quadro ? 255 : atual[i]];
+        pwm_set_chan_level(saidas[i].slice, saidas[i].canal, nivel);
+    }
+}
+
+static void ao_fim_do_ciclo(void) {
+    pwm_clear_irq(slice_interrupcao);
+    tempo_ms++;
+
+    switch (tipo) {
+        case EFEITO_TRANSICAO:
+            if (tempo_ms >= duracao_ms) {
+                for (uint8_t i = 0; i < 3; i++) atual[i] = destino[i];
+                tipo = EFEITO_FIXO;
+                pwm_set_irq_enabled(slice_interrupcao, false);
+            } else {
+                for (uint8_t i = 0; i < 3; i++) {
+                    int32_t diferenca = (int32_t)destino[i] - origem[i];
+                    atual[i] = (uint8_t)(origem[i] + diferenca * (int32_t)tempo_ms / (int32_t)duracao_ms);
+                }
+            }
+            break;
+        case EFEITO_RESPIRAR: {
+            // Onda triangular na intensidade perceptual: com a gama, a
+            // variação de brilho parece uniforme
+            uint32_t fase = tempo_ms % duracao_ms;
+            uint32_t metade = duracao_ms / 2;
+            // Com período ímpar a descida é 1 ms mais longa que a subida
+            uint32_t fator = fase < metade ? fase * 255 / metade
+                                           : (duracao_ms - fase) * 255 / (duracao_ms - metade);
+            for (uint8_t i = 0; i < 3; i++) atual[i] = (uint8_t)(destino[i] * fator / 255);
+            break;
+        }
+        case EFEITO_PISCAR: {
+            bool aceso = tempo_ms % duracao_ms < duracao_ms / 2;
+            for (uint8_t i = 0; i < 3; i++) atual[i] = aceso ? destino[i] : 0;
+            break;
+        }
+        case EFEITO_FIXO:
+            pwm_set_irq_enabled(slice_interrupcao, false);
+            return;
+    }
+    if (!suspenso && !enviando_quadro) {
+        escrever_niveis();
+    }
+}
+
+void led_rgb_iniciar(uint pino_vermelho, uint pino_verde, uint pino_azul) {
+    const uint pinos[3] = {pino_vermelho, pino_verde, pino_azul};
+
+    pwm_config configuracao = pwm_get_default_config();
+    pwm_config_set_clkdiv(&configuracao, (float)clock_get_hz(clk_sys) / (LED_PWM_HZ * (LED_PWM_TOPO + 1.0f)));
+    pwm_config_set_wrap(&configuracao, LED_PWM_TOPO);
+
+    for (uint8_t i = 0; i < 3; i++) {
+        gpio_set_function(pinos[i], GPIO_FUNC_PWM);
+        saidas[i].slice = pwm_gpio_to_slice_num(pinos[i]);
+        saidas[i].canal = pwm_gpio_to_channel(pinos[i]);
+        pwm_init(saidas[i].slice, &configuracao, true);
+        pwm_set_chan_level(saidas[i].slice, saidas[i].canal, 0);
+    }
+
+    // Um único slice marca o passo dos efeitos das três cores
+    slice_interrupcao = saidas[0].slice;
+    pwm_clear_irq(slice_interrupcao);
+    irq_set_exclusive_handler(PWM_IRQ_WRAP, ao_fim_do_ciclo);
+    irq_set_enabled(PWM_IRQ_WRAP, true);
+}
+
+// Troca o efeito partindo da cor exibida no momento
+static void iniciar_efeito(TipoEfeito novo, CorRgb cor, uint32_t duracao) {
+    pwm_set_irq_enabled(slice_interrupcao, false);
+    const uint8_t componentes[3] = {cor.r, cor.g, cor.b};
+    for (uint8_t i = 0; i < 3; i++) {
+        origem[i] = atual[i];
+        destino[i] = componentes[i];
+    }
+    // Mudar só a cor de uma respiração ou pisca não reinicia a fase
+    if (novo != tipo || duracao != duracao_ms) {
+        tempo_ms = 0;
+    }
+    duracao_ms = duracao;
+    tipo = novo;
+
+    if (novo == EFEITO_FIXO) {
+        for (uint8_t i = 0; i < 3; i++) atual[i] = destino[i];
+        escrever_niveis();
+    } else if (!suspenso) {
+        pwm_set_irq_enabled(slice_interrupcao, true);
+    }
+}
+
+void led_rgb_definir(CorRgb cor, uint16_t transicao_ms) {
+    iniciar_efeito(transicao_ms ? EFEITO_TRANSICAO : EFEITO_FIXO, cor, transicao_ms);
+}
+
+void led_rgb_respirar(CorRgb cor, uint16_t periodo_ms) {
+    iniciar_efeito(EFEITO_RESPIRAR, cor, periodo_ms < 2 ? 2 : periodo_ms);
+}
+
+void led_rgb_piscar(CorRgb cor, uint16_t periodo_ms) {
+    iniciar_efeito(EFEITO_PISCAR, cor, periodo_ms < 2 ? 2 : periodo_ms);
+}
+
+// Apaga o LED sem perder o efeito, que continua de onde parou ao voltar
+void led_rgb_suspender(bool suspender) {
+    suspenso = suspender;
+    pwm_set_irq_enabled(slice_interrupcao, !suspender && tipo != EFEITO_FIXO);
+    escrever_niveis();
+}
+
+void led_rgb_habilitar_sinal_envio(bool habilitar) {
+    sinal_envio = habilitar;
+    if (!habilitar && enviando_quadro) {
+        enviando_quadro = false;
+        escrever_niveis();
+    }
+}
+
+bool led_rgb_sinal_envio_habilitado(void) {
+    return sinal_envio;
+}
+
+// Três escritas nos registradores de comparação: barato o bastante para
+// cercar cada envio de quadro
+void led_rgb_sinalizar_envio(bool enviando) {
+    if (!sinal_envio || suspenso) {
+        return;
+    }
+    enviando_quadro = enviando;
+    escrever_niveis();
+}
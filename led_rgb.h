@@ -0,0 +1,29 @@
+#ifndef LED_RGB_H
+#define LED_RGB_H
+
+#include "pico/stdlib.h"
+
+// LED RGB de status por PWM com correção gama. Transições, respiração e
+// pisca são avançados pela interrupção de fim de ciclo do PWM (1 por ms),
+// ligada só enquanto há um efeito em andamento: o laço principal apenas
+// escolhe o efeito. As intensidades são perceptuais (0 a 255).
+#define LED_PWM_HZ 1000             // Frequência do PWM e dos passos dos efeitos
+#define LED_PWM_TOPO 4095           // 12 bits de resolução após a correção gama
+
+typedef struct {
+    uint8_t r, g, b;
+} CorRgb;
+
+void led_rgb_iniciar(uint pino_vermelho, uint pino_verde, uint pino_azul);
+void led_rgb_definir(CorRgb cor, uint16_t transicao_ms);
+void led_rgb_respirar(CorRgb cor, uint16_t periodo_ms);
+void led_rgb_piscar(CorRgb cor, uint16_t periodo_ms);
+void led_rgb_suspender(bool suspender);
+
+// Sinal de atividade: com o sinal habilitado o LED fica branco enquanto um
+// quadro é enviado ao display
+void led_rgb_habilitar_sinal_envio(bool habilitar);
+bool led_rgb_sinal_envio_habilitado(void);
+void led_rgb_sinalizar_envio(bool enviando);
+
+#endif // LED_RGB_H
@@ -2,6 +2,16 @@
 #include "hardware/adc.h"
 #include "hardware/gpio.h"
 #include "funcoes_graficas.h"  
+#include "comandos_usb.h"
+#include "agendador.h"
+#include "energia.h"
+#include "botoes.h"
+#include "escala_cinza.h"
+#include "sessao.h"
+#include "partida.h"
+#include "led_rgb.h"
+#include "memoria.h"
+#include <math.h>
 #include "Matriz_Bibliotecas/matriz_led.h"       
 
 // Definições de hardware 
@@ -9,7 +19,6 @@
 #define PINO_BOTAO_JOYSTICK 22
 #define PINO_BOTAO_A 5
 #define PINO_BOTAO_B 6
-#define ATRASO_DEBOUNCE_MS 300
 #define ZONA_MORTA 300
 
 // Definições dos pinos RGB
@@ -20,135 +29,243 @@
 // Variável global (Sistema) 
 extern Sistema sistema; 
 
-void tratar_interrupcao_gpio(uint gpio, uint32_t events);
+void tratar_evento_botao(const EventoBotao *evento);
 
 int main() {
+    // Antes de tudo, para que a marca d'água cubra a partida inteira
+    memoria_pintar_pilhas();
     stdio_init_all();
+    partida_marcar(PARTIDA_STDIO);
 
-    // Inicialização do sistema
+    // Inicialização do sistema; a configuração do display segue por DMA
+    // enquanto os demais periféricos são configurados
     inicializar_sistema(&sistema);
+    partida_marcar(PARTIDA_SISTEMA);
 
     // Configuração dos botões
     const uint pinos[] = {PINO_BOTAO_JOYSTICK, PINO_BOTAO_A, PINO_BOTAO_B};
-    for (int i = 0; i < 3; i++) {
-        gpio_init(pinos[i]);
-        gpio_set_dir(pinos[i], GPIO_IN);
-        gpio_pull_up(pinos[i]);
-        gpio_set_irq_enabled_with_callback(pinos[i], GPIO_IRQ_EDGE_FALL, true, &tratar_interrupcao_gpio);
-    }
+    botoes_iniciar(pinos, 3);
 
     // Configuração ADC
     adc_init();
     adc_gpio_init(PINO_JOYSTICK_Y);
-    gpio_set_function(PINO_RGB_VERMELHO, GPIO_FUNC_PWM);
-    gpio_set_function(PINO_RGB_VERDE, GPIO_FUNC_PWM);
-    gpio_set_function(PINO_RGB_AZUL, GPIO_FUNC_PWM);
-
-    uint slice_vermelho = pwm_gpio_to_slice_num(PINO_RGB_VERMELHO);
-    uint slice_verde = pwm_gpio_to_slice_num(PINO_RGB_VERDE);
-    uint slice_azul = pwm_gpio_to_slice_num(PINO_RGB_AZUL);
-
-    pwm_set_wrap(slice_vermelho, 255);
-    pwm_set_wrap(slice_verde, 255);
-    pwm_set_wrap(slice_azul, 255);
 
-    pwm_set_enabled(slice_vermelho, true);
-    pwm_set_enabled(slice_verde, true);
-    pwm_set_enabled(slice_azul, true);
+    // LED RGB de status (PWM com correção gama e efeitos por interrupção)
+    led_rgb_iniciar(PINO_RGB_VERMELHO, PINO_RGB_VERDE, PINO_RGB_AZUL);
+    partida_marcar(PARTIDA_PERIFERICOS);
 
     // Estado inicial
-    sistema.estado_atual = ESTADO_MENU;
+    definir_estado(&sistema, ESTADO_MENU);
     sistema.funcao_selecionada = FUNCAO_AFIM;
-    sistema.tempo_ultimo_botao = get_absolute_time();
     sistema.nivel_zoom = 1.0;
     sistema.posicao_central_x = 0.0;
+    restaurar_vista(&sistema);
 
     atualizar_cores_rgb();
     atualizar_brilho_zoom();
 
-    desenhar_tela_menu(&sistema);
+    // O menu é o primeiro quadro enviado ao display
+    exibir_primeiro_quadro(&sistema);
+
+    agendador_iniciar(0, ZONA_MORTA);
+    energia_iniciar(TEMPO_OCIOSO_PADRAO_MS);
+    partida_marcar(PARTIDA_LACO);
+    partida_imprimir();
 
     while (true) {
+        // Dorme até um evento; a animação e a pré-renderização do gráfico
+        // mantêm o laço acordado e os tons de cinza acordam no prazo do
+        // próximo subquadro
+        int64_t prazo_us = energia_prazo_ocioso_us();
+        if (sistema.animacao.ativa) {
+            prazo_us = 0;
+        } else if (sistema.estado_atual == ESTADO_CONFIGURAR_PARAMETROS && pre_renderizacao_pendente(&sistema)) {
+            prazo_us = 0;
+        } else if (escala_cinza_ativa()) {
+            prazo_us = escala_cinza_prazo_us();
+        }
+        uint32_t eventos = agendador_aguardar(sessao_prazo_us(prazo_us));
+
+        if ((eventos & EVENTOS_ENTRADA) && energia_registrar_atividade(&sistema)) {
+            // Botões e joystick apenas acordaram o display: são descartados
+            botoes_descartar_eventos();
+            eventos &= ~(EVENTO_BOTAO | EVENTO_JOYSTICK);
+        }
+        eventos = sessao_filtrar_eventos(eventos);
+
+        processar_comandos_usb(&sistema);
+
+        EventoBotao evento;
+        while (sessao_proximo_botao(&evento)) {
+            tratar_evento_botao(&evento);
+        }
+
+        // Os tons de cinza e o cursor só existem na tela do gráfico
+        if (sistema.estado_atual != ESTADO_EXIBIR_GRAFICO) {
+            definir_escala_cinza(&sistema, false);
+            definir_cursor(&sistema, false);
+        }
+
         switch (sistema.estado_atual) {
             case ESTADO_MENU:
-                gerenciar_estado_menu(&sistema);
+                if (eventos & EVENTO_JOYSTICK) {
+                    gerenciar_estado_menu(&sistema);
+                }
                 break;
             case ESTADO_CONFIGURAR_PARAMETROS:
-                // Tratado por interrupções
+                // Os botões editam; no tempo livre o gráfico vai sendo preparado
+                pre_renderizar_grafico(&sistema);
                 break;
             case ESTADO_EXIBIR_GRAFICO:
-                gerenciar_estado_grafico(&sistema);
+                if ((eventos & EVENTO_JOYSTICK) || sistema.animacao.ativa) {
+                    gerenciar_estado_grafico(&sistema);
+                }
+                atualizar_escala_cinza(&sistema);
                 break;
             case ESTADO_EXIBIR_VALORES:
                 // Não precisa fazer nada aqui, pois é estático
                 break;
+            case ESTADO_EXIBIR_TABELA:
+                if (eventos & EVENTO_JOYSTICK) {
+                    gerenciar_estado_tabela(&sistema);
+                }
+                break;
+            case ESTADO_OSCILOSCOPIO:
+                if (eventos & (EVENTO_JOYSTICK | EVENTO_OSCILOSCOPIO)) {
+                    gerenciar_estado_osciloscopio(&sistema);
+                }
+                break;
         }
-        sleep_ms(50);
+
+        energia_verificar_ociosidade(&sistema);
+        sessao_verificar_fim(&sistema);
     }
     return 0;
 }
 
-void tratar_interrupcao_gpio(uint gpio, uint32_t events) {
-    absolute_time_t agora = get_absolute_time();
+// Soma ao parâmetro um passo acelerado, alinhando o valor a múltiplos do passo
+static void ajustar_parametro(float sentido, uint16_t repeticoes) {
+    float passo = botoes_passo_acelerado(repeticoes);
+    float *valor = &sistema.parametros[sistema.indice_parametro_atual];
+    if (sentido > 0) {
+        *valor = floorf(*valor / passo + 0.001f) * passo + passo;
+    } else {
+        *valor = ceilf(*valor / passo - 0.001f) * passo - passo;
+    }
+    desenhar_tela_configuracao_parametros(&sistema);
+}
+
+void tratar_evento_botao(const EventoBotao *evento) {
+    uint gpio = evento->pino;
+
+    // Ajuste de parâmetros: responde já na pressão e repete enquanto o botão é mantido
+    if (sistema.estado_atual == ESTADO_CONFIGURAR_PARAMETROS && gpio != PINO_BOTAO_JOYSTICK) {
+        if (evento->tipo == BOTAO_PRESSIONAR || evento->tipo == BOTAO_LONGO || evento->tipo == BOTAO_REPETIR) {
+            ajustar_parametro(gpio == PINO_BOTAO_A ? 1.0f : -1.0f, evento->repeticoes);
+        }
+        return;
+    }
+
+    // Osciloscópio: A alterna a borda do gatilho (pressão longa centraliza o
+    // nível na onda) e B congela a tela
+    if (sistema.estado_atual == ESTADO_OSCILOSCOPIO && gpio != PINO_BOTAO_JOYSTICK) {
+        if (evento->tipo == BOTAO_LONGO && gpio == PINO_BOTAO_A) {
+            ajustar_nivel_osciloscopio(&sistema);
+        } else if (evento->tipo == BOTAO_CURTO && gpio == PINO_BOTAO_A) {
+            alternar_borda_osciloscopio(&sistema);
+        } else if (evento->tipo == BOTAO_CURTO && gpio == PINO_BOTAO_B) {
+            alternar_congelamento_osciloscopio(&sistema);
+        }
+        return;
+    }
+
+    // Pressão longa do botão do joystick no menu abre o osciloscópio
+    if (evento->tipo == BOTAO_LONGO && gpio == PINO_BOTAO_JOYSTICK && sistema.estado_atual == ESTADO_MENU) {
+        iniciar_osciloscopio(&sistema);
+        return;
+    }
+
+    // Pressão longa de B no gráfico liga/desliga os tons de cinza
+    if (evento->tipo == BOTAO_LONGO && gpio == PINO_BOTAO_B && sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        definir_escala_cinza(&sistema, !escala_cinza_ativa());
+        return;
+    }
+
+    // Pressão longa do botão do joystick no gráfico liga/desliga o cursor de leitura
+    if (evento->tipo == BOTAO_LONGO && gpio == PINO_BOTAO_JOYSTICK && sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        definir_cursor(&sistema, !sistema.cursor_ativo);
+        return;
+    }
 
-    // Verificação de debounce
-    if (absolute_time_diff_us(sistema.tempo_ultimo_botao, agora) < ATRASO_DEBOUNCE_MS * 1000) {
+    // Pressão longa de A no gráfico enquadra a curva automaticamente
+    if (evento->tipo == BOTAO_LONGO && gpio == PINO_BOTAO_A && sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
+        ajustar_vista(&sistema);
         return;
     }
 
-    sistema.tempo_ultimo_botao = agora;
+    // Demais ações acontecem ao soltar, deixando a pressão longa livre
+    if (evento->tipo != BOTAO_CURTO) {
+        return;
+    }
 
     if (gpio == PINO_BOTAO_JOYSTICK) {
         if (sistema.estado_atual == ESTADO_MENU) {
-            sistema.estado_atual = ESTADO_CONFIGURAR_PARAMETROS;
+            definir_estado(&sistema, ESTADO_CONFIGURAR_PARAMETROS);
             sistema.indice_parametro_atual = 0;
             sistema.parametros[0] = 0.0;  // Resetar parâmetros
             sistema.parametros[1] = 0.0;
             sistema.parametros[2] = 0.0;
             sistema.parametros[3] = 0.0;
+            restaurar_vista(&sistema);
+            sistema.analise.ativa = false;  // Limites da integral valem para a função anterior
+            definir_limites_analise(&sistema, 0.0f, 0.0f);
             desenhar_tela_configuracao_parametros(&sistema);
         } else if (sistema.estado_atual == ESTADO_CONFIGURAR_PARAMETROS) {
             if (sistema.indice_parametro_atual < 3) {  // A, B, C e D para função cossenoidal
                 sistema.indice_parametro_atual++;
                 desenhar_tela_configuracao_parametros(&sistema);
             } else {
-                sistema.estado_atual = ESTADO_EXIBIR_GRAFICO;
-                switch (sistema.funcao_selecionada) {
-                  case FUNCAO_AFIM:
-                      plotar_grafico_funcao_afim(&sistema);
-                      break;
-                  case FUNCAO_QUADRATICA:
-                      plotar_grafico_funcao_quadratica(&sistema);
-                      break;
-                  case FUNCAO_SENOIDAL:
-                      plotar_grafico_funcao_senoidal(&sistema);
-                      break;
-                  case FUNCAO_COSSENOIDAL:
-                      plotar_grafico_funcao_cossenoidal(&sistema);
-                      break;
-                }
+                definir_estado(&sistema, ESTADO_EXIBIR_GRAFICO);
+                exibir_grafico_preparado(&sistema);
             }
         } else if (sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
-            if (sistema.funcao_selecionada == FUNCAO_QUADRATICA) {
-                sistema.estado_atual = ESTADO_EXIBIR_VALORES;
+            parar_animacao(&sistema);
+            // Com o segundo display os valores da quadrática já estão no painel de dados
+            if (sistema.funcao_selecionada == FUNCAO_QUADRATICA && !SEGUNDA_TELA_ATIVA) {
+                definir_estado(&sistema, ESTADO_EXIBIR_VALORES);
                 desenhar_tela_valores_quadratica(&sistema);
+            } else if (funcao_cartesiana(sistema.funcao_selecionada)) {
+                definir_estado(&sistema, ESTADO_EXIBIR_TABELA);
+                iniciar_tabela(&sistema);
             } else {
-                sistema.estado_atual = ESTADO_MENU;
+                definir_estado(&sistema, ESTADO_MENU);
                 desenhar_tela_menu(&sistema);
             }
         } else if (sistema.estado_atual == ESTADO_EXIBIR_VALORES) {
-            sistema.estado_atual = ESTADO_MENU;
+            definir_estado(&sistema, ESTADO_EXIBIR_TABELA);
+            iniciar_tabela(&sistema);
+        } else if (sistema.estado_atual == ESTADO_EXIBIR_TABELA) {
+            definir_estado(&sistema, ESTADO_MENU);
+            desenhar_tela_menu(&sistema);
+        } else if (sistema.estado_atual == ESTADO_OSCILOSCOPIO) {
+            definir_estado(&sistema, ESTADO_MENU);  // Também para a captura
             desenhar_tela_menu(&sistema);
         }
     } else if (gpio == PINO_BOTAO_A) {
-        if (sistema.estado_atual == ESTADO_CONFIGURAR_PARAMETROS) {
-            sistema.parametros[sistema.indice_parametro_atual] += 0.5;
-            desenhar_tela_configuracao_parametros(&sistema);
+        if (sistema.estado_atual == ESTADO_EXIBIR_GRAFICO && sistema.cursor_ativo) {
+            marcar_limite_analise(&sistema, false);  // Início da integral no cursor
+        } else if (sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
+            alternar_animacao(&sistema);  // Liga/desliga a varredura do parâmetro
+        } else if (sistema.estado_atual == ESTADO_EXIBIR_TABELA) {
+            alterar_passo_tabela(&sistema, -1);  // Passo menor entre as linhas
         }
     } else if (gpio == PINO_BOTAO_B) {
-        if (sistema.estado_atual == ESTADO_CONFIGURAR_PARAMETROS) {
-            sistema.parametros[sistema.indice_parametro_atual] -= 0.5;
-            desenhar_tela_configuracao_parametros(&sistema);
+        if (sistema.estado_atual == ESTADO_EXIBIR_GRAFICO && sistema.cursor_ativo) {
+            marcar_limite_analise(&sistema, true);  // Fim da integral no cursor
+        } else if (sistema.estado_atual == ESTADO_EXIBIR_GRAFICO) {
+            selecionar_parametro_animacao(&sistema);  // Próximo parâmetro a varrer
+        } else if (sistema.estado_atual == ESTADO_EXIBIR_TABELA) {
+            alterar_passo_tabela(&sistema, 1);  // Passo maior entre as linhas
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "memoria.h"
+#include <stdio.h>
+#include <malloc.h>
+
+// Símbolos do script de ligação padrão do SDK (memmap_default.ld)
+extern uint32_t __StackBottom, __StackTop;          // Core 0 (SCRATCH_Y)
+extern uint32_t __StackOneBottom, __StackOneTop;    // Core 1 (SCRATCH_X)
+extern char __data_start__, __data_end__;
+extern char __bss_start__, __bss_end__;
+extern char __flash_binary_start, __flash_binary_end;
+extern char end, __StackLimit;                      // Heap: de end até __StackLimit
+
+static bool pilhas_pintadas = false;
+
+static void pintar(uint32_t *inicio, uint32_t *fim) {
+    for (volatile uint32_t *palavra = inicio; palavra < fim; palavra++) {
+        *palavra = MEMORIA_PADRAO_PILHA;
+    }
+}
+
+// Bytes da pilha já usados: do topo até a palavra mais funda sem o padrão
+static uint32_t pilha_usada(const uint32_t *fundo, const uint32_t *topo) {
+    const uint32_t *palavra = fundo;
+    while (palavra < topo && *palavra == MEMORIA_PADRAO_PILHA) {
+        palavra++;
+    }
+    return (uint32_t)((const char *)topo - (const char *)palavra);
+}
+
+// Chamada no início de main: a pilha do core 0 é pintada até um pouco abaixo
+// do quadro atual e a do core 1 (sem uso por enquanto) inteira
+void memoria_pintar_pilhas(void) {
+    uint32_t marcador;
+    uint32_t *limite = (uint32_t *)((uintptr_t)&marcador - MEMORIA_MARGEM_PINTURA);
+    pintar(&__StackBottom, limite);
+    pintar(&__StackOneBottom, &__StackOneTop);
+    pilhas_pintadas = true;
+}
+
+static void relatar_pilha(const char *nome, uint32_t *fundo, uint32_t *topo) {
+    uint32_t tamanho = (uint32_t)((char *)topo - (char *)fundo);
+    uint32_t usada = pilha_usada(fundo, topo);
+    printf("Memoria: pilha %s %u de %u bytes (%u%%)%s\n", nome, (unsigned)usada, (unsigned)tamanho,
+           (unsigned)(tamanho ? usada * 100 / tamanho : 0),
+           usada >= tamanho ? " ESTOURO" : "");
+}
+
+void memoria_relatar(void) {
+    if (!pilhas_pintadas) {
+        printf("Memoria: pilhas nao pintadas\n");
+    } else {
+        relatar_pilha("core0+irq", &__StackBottom, &__StackTop);
+        relatar_pilha("core1", &__StackOneBottom, &__StackOneTop);
+    }
+
+    // O heap só cresce (sbrk): arena é a marca d'água, uordblks o uso atual
+    struct mallinfo info = mallinfo();
+    printf("Memoria: heap em uso %u, reservado %u de %u bytes\n", (unsigned)info.uordblks,
+           (unsigned)info.arena, (unsigned)(&__StackLimit - &end));
+
+    printf("Memoria: estatica data %u bss %u bytes, flash %u bytes\n",
+           (unsigned)(&__data_end__ - &__data_start__), (unsigned)(&__bss_end__ - &__bss_start__),
+           (unsigned)(&__flash_binary_end - &__flash_binary_start));
+}
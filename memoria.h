@@ -0,0 +1,17 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include "pico/stdlib.h"
+
+// Uso de memória em tempo de execução. As pilhas são pintadas com um padrão
+// na partida e a marca d'água é a palavra mais funda que perdeu o padrão.
+// No RP2040 as interrupções usam a mesma pilha (MSP) do código do core, então
+// a marca do core 0 já inclui a profundidade das ISRs. O heap vem do
+// mallinfo do newlib e as seções estáticas dos símbolos do linker.
+#define MEMORIA_PADRAO_PILHA 0xDEADBEEFu
+#define MEMORIA_MARGEM_PINTURA 64       // Bytes abaixo da pilha atual preservados
+
+void memoria_pintar_pilhas(void);
+void memoria_relatar(void);
+
+#endif // MEMORIA_H
@@ -0,0 +1,368 @@
+#include "osciloscopio.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "agendador.h"
+
+#define RELOGIO_ADC_HZ 48000000.0f
+#define CICLOS_CONVERSAO 96           // Divisores menores que isso não aceleram o ADC
+#define HISTERESE 32                  // Margem para rearmar a borda, contra ruído
+#define AUTOMATICO_MS 100             // Sem borda nesse tempo, o quadro sai sem gatilho
+
+// Blocos alinhados ao próprio tamanho: o anel de escrita do DMA volta ao
+// início sozinho e o encadeamento dispara o outro canal sem ajuda da CPU
+static uint16_t blocos[2][OSC_AMOSTRAS_BLOCO] __attribute__((aligned(OSC_AMOSTRAS_BLOCO * 2)));
+static int canais_dma[2] = {-1, -1};
+static bool ativo = false;
+
+static uint canal_sinal = OSC_CANAL_PADRAO;
+static uint canal_joystick;
+static uint8_t passo_amostras = 1;    // 2 quando o joystick é convertido entre as amostras
+static uint8_t indice_sinal = 0;      // Posição do sinal no par entrelaçado
+static volatile uint32_t taxa = OSC_TAXA_PADRAO;
+static volatile uint16_t ultima_amostra_sinal = 2048;
+static volatile uint16_t ultima_amostra_joystick = 2048;
+
+// Gatilho
+static volatile BordaGatilho borda = GATILHO_SUBIDA;
+static volatile uint16_t nivel = OSC_NIVEL_PADRAO;
+static volatile uint32_t limite_automatico;
+static bool preparado = false;        // Passou do lado oposto da borda
+static uint32_t aguardando = 0;       // Amostras desde que o gatilho foi armado
+static bool capturando = false;
+
+// Decimação: posição em colunas (Q16) da próxima amostra
+static volatile uint32_t colunas_por_amostra_q16 = 1u << 12;
+static uint32_t passo_q16;
+static uint32_t posicao_q16;
+static int16_t ultima_coluna;
+static uint16_t amostra_anterior;
+
+// Três quadros: a interrupção escreve em um, o mais recente completo espera
+// no segundo e o laço principal lê o terceiro
+static QuadroOsciloscopio quadros[3];
+static uint8_t quadro_escrita = 0;
+static uint8_t quadro_pronto = 1;
+static uint8_t quadro_leitura = 2;
+static volatile bool quadro_novo = false;
+
+static uint32_t sequencia_quadros = 0;
+static EstatisticasOsciloscopio estatisticas;
+
+static void __not_in_flash_func(publicar_quadro)(void) {
+    quadros[quadro_escrita].sequencia = ++sequencia_quadros;
+    estatisticas.quadros++;
+    uint8_t anterior = quadro_pronto;
+    quadro_pronto = quadro_escrita;
+    quadro_escrita = anterior;
+
+    // Só acorda o laço se ele já levou o quadro anterior
+    if (!quadro_novo) {
+        quadro_novo = true;
+        agendador_sinalizar(EVENTO_OSCILOSCOPIO);
+    }
+    capturando = false;
+    preparado = false;
+    aguardando = 0;
+}
+
+static void __not_in_flash_func(disparar)(bool borda_encontrada) {
+    quadros[quadro_escrita].disparado = borda_encontrada;
+    quadros[quadro_escrita].taxa = taxa;
+    quadros[quadro_escrita].colunas_por_amostra_q16 = colunas_por_amostra_q16;
+    if (!borda_encontrada && borda != GATILHO_LIVRE) {
+        estatisticas.automaticos++;
+    }
+    passo_q16 = quadros[quadro_escrita].colunas_por_amostra_q16;
+    posicao_q16 = 0;
+    ultima_coluna = -1;
+    capturando = true;
+}
+
+// Com o gatilho armado, verifica se a amostra completa a borda
+static bool __not_in_flash_func(verificar_gatilho)(uint16_t amostra) {
+    switch (borda) {
+        case GATILHO_SUBIDA:
+            if (amostra + HISTERESE < nivel) {
+                preparado = true;
+            } else if (preparado && amostra >= nivel) {
+                disparar(true);
+                return true;
+            }
+            break;
+        case GATILHO_DESCIDA:
+            if (amostra > nivel + HISTERESE) {
+                preparado = true;
+            } else if (preparado && amostra <= nivel) {
+                disparar(true);
+                return true;
+            }
+            break;
+        default:
+            disparar(false);
+            return true;
+    }
+
+    if (++aguardando >= limite_automatico) {
+        disparar(false);
+        return true;
+    }
+    return false;
+}
+
+// Mínimo e máximo por coluna; com menos de uma amostra por coluna, as
+// colunas puladas recebem a interpolação entre as amostras vizinhas
+static void __not_in_flash_func(acumular)(uint16_t amostra) {
+    QuadroOsciloscopio *quadro = &quadros[quadro_escrita];
+    int16_t coluna = (int16_t)(posicao_q16 >> 16);
+
+    if (coluna == ultima_coluna) {
+        if (amostra < quadro->minimo[coluna]) quadro->minimo[coluna] = amostra;
+        if (amostra > quadro->maximo[coluna]) quadro->maximo[coluna] = amostra;
+    } else {
+        for (int16_t c = ultima_coluna + 1; c < coluna && c < OSC_COLUNAS; c++) {
+            int32_t valor = ultima_coluna < 0 ? amostra :
+                amostra_anterior + ((int32_t)amostra - amostra_anterior) * (c - ultima_coluna) / (coluna - ultima_coluna);
+            quadro->minimo[c] = (uint16_t)valor;
+            quadro->maximo[c] = (uint16_t)valor;
+        }
+        if (coluna >= OSC_COLUNAS) {
+            publicar_quadro();
+            return;
+        }
+        quadro->minimo[coluna] = amostra;
+        quadro->maximo[coluna] = amostra;
+        ultima_coluna = coluna;
+    }
+    amostra_anterior = amostra;
+    posicao_q16 += passo_q16;
+}
+
+static void __not_in_flash_func(processar_bloco)(const uint16_t *amostras) {
+    estatisticas.blocos++;
+    for (uint16_t i = indice_sinal; i < OSC_AMOSTRAS_BLOCO; i += passo_amostras) {
+        uint16_t amostra = amostras[i] & OSC_NIVEL_MAXIMO;
+        if (capturando || verificar_gatilho(amostra)) {
+            acumular(amostra);
+        }
+    }
+    ultima_amostra_sinal = amostras[OSC_AMOSTRAS_BLOCO - passo_amostras + indice_sinal] & OSC_NIVEL_MAXIMO;
+    if (passo_amostras == 2) {
+        ultima_amostra_joystick = amostras[OSC_AMOSTRAS_BLOCO - 2 + (indice_sinal ^ 1)] & OSC_NIVEL_MAXIMO;
+    }
+}
+
+static void __not_in_flash_func(ao_fim_do_bloco)(void) {
+    for (uint8_t b = 0; b < 2; b++) {
+        if (!dma_channel_get_irq1_status(canais_dma[b])) {
+            continue;
+        }
+        dma_channel_acknowledge_irq1(canais_dma[b]);
+        // Os dois blocos terminados: o DMA já está reescrevendo este
+        if (dma_channel_get_irq1_status(canais_dma[b ^ 1])) {
+            estatisticas.atrasos++;
+        }
+        processar_bloco(blocos[b]);
+    }
+}
+
+// Divisor do ADC para a taxa do sinal (as conversões do joystick contam)
+static void aplicar_taxa(void) {
+    uint32_t conversoes = taxa * passo_amostras;
+    if (conversoes > OSC_TAXA_ADC_MAXIMA) {
+        conversoes = OSC_TAXA_ADC_MAXIMA;
+    }
+    float periodo = RELOGIO_ADC_HZ / conversoes;
+    if (periodo < CICLOS_CONVERSAO) {
+        periodo = CICLOS_CONVERSAO;
+    }
+    adc_set_clkdiv(periodo - 1.0f);
+    taxa = (uint32_t)(RELOGIO_ADC_HZ / periodo) / passo_amostras;
+    limite_automatico = taxa * AUTOMATICO_MS / 1000;
+}
+
+bool osciloscopio_iniciar(uint canal, uint canal_joy) {
+    if (ativo) {
+        osciloscopio_parar();
+    }
+    if (canal > 2) {
+        return false;
+    }
+    canais_dma[0] = dma_claim_unused_channel(false);
+    canais_dma[1] = dma_claim_unused_channel(false);
+    if (canais_dma[0] < 0 || canais_dma[1] < 0) {
+        for (uint8_t b = 0; b < 2; b++) {
+            if (canais_dma[b] >= 0) dma_channel_unclaim(canais_dma[b]);
+            canais_dma[b] = -1;
+        }
+        return false;
+    }
+
+    canal_sinal = canal;
+    canal_joystick = canal_joy;
+    adc_gpio_init(26 + canal);
+    if (canal == canal_joy) {
+        passo_amostras = 1;
+        indice_sinal = 0;
+        adc_set_round_robin(0);
+        adc_select_input(canal);
+    } else {
+        // O round robin converte os canais em ordem crescente a partir do selecionado
+        passo_amostras = 2;
+        indice_sinal = canal > canal_joy;
+        adc_select_input(canal < canal_joy ? canal : canal_joy);
+        adc_set_round_robin((1u << canal) | (1u << canal_joy));
+    }
+    adc_fifo_setup(true, true, 1, false, false);
+    aplicar_taxa();
+
+    capturando = false;
+    preparado = false;
+    aguardando = 0;
+    quadro_novo = false;
+
+    for (uint8_t b = 0; b < 2; b++) {
+        dma_channel_config configuracao = dma_channel_get_default_config(canais_dma[b]);
+        channel_config_set_transfer_data_size(&configuracao, DMA_SIZE_16);
+        channel_config_set_read_increment(&configuracao, false);
+        channel_config_set_write_increment(&configuracao, true);
+        channel_config_set_ring(&configuracao, true, __builtin_ctz(sizeof(blocos[b])));
+        channel_config_set_dreq(&configuracao, DREQ_ADC);
+        channel_config_set_chain_to(&configuracao, canais_dma[b ^ 1]);
+        dma_channel_configure(canais_dma[b], &configuracao, blocos[b], &adc_hw->fifo,
+                              OSC_AMOSTRAS_BLOCO, false);
+        dma_channel_set_irq1_enabled(canais_dma[b], true);
+    }
+    irq_set_exclusive_handler(DMA_IRQ_1, ao_fim_do_bloco);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    dma_channel_start(canais_dma[0]);
+    adc_run(true);
+    ativo = true;
+    return true;
+}
+
+void osciloscopio_parar(void) {
+    if (!ativo) {
+        return;
+    }
+    adc_run(false);
+    irq_set_enabled(DMA_IRQ_1, false);
+    for (uint8_t b = 0; b < 2; b++) {
+        // Sem a interrupção antes do abort (errata RP2040-E13)
+        dma_channel_set_irq1_enabled(canais_dma[b], false);
+    }
+    for (uint8_t b = 0; b < 2; b++) {
+        dma_channel_abort(canais_dma[b]);
+        dma_channel_acknowledge_irq1(canais_dma[b]);
+        dma_channel_unclaim(canais_dma[b]);
+        canais_dma[b] = -1;
+    }
+    irq_remove_handler(DMA_IRQ_1, ao_fim_do_bloco);
+
+    // Volta ao modo de leitura avulsa usado pelo joystick
+    adc_fifo_setup(false, false, 0, false, false);
+    adc_fifo_drain();
+    adc_set_round_robin(0);
+    adc_set_clkdiv(0);
+    adc_select_input(canal_joystick);
+    ativo = false;
+}
+
+bool osciloscopio_ativo(void) {
+    return ativo;
+}
+
+uint32_t osciloscopio_definir_taxa(uint32_t taxa_hz) {
+    uint32_t maxima = osciloscopio_taxa_maxima();
+    taxa = taxa_hz < OSC_TAXA_MINIMA ? OSC_TAXA_MINIMA : (taxa_hz > maxima ? maxima : taxa_hz);
+    if (ativo) {
+        aplicar_taxa();
+    }
+    return taxa;
+}
+
+uint32_t osciloscopio_taxa(void) {
+    return taxa;
+}
+
+// Com o joystick entrelaçado o sinal fica com metade das conversões
+uint32_t osciloscopio_taxa_maxima(void) {
+    return canal_sinal == canal_joystick ? OSC_TAXA_ADC_MAXIMA : OSC_TAXA_ADC_MAXIMA / 2;
+}
+
+bool osciloscopio_definir_canal(uint canal) {
+    if (canal > 2) {
+        return false;
+    }
+    if (ativo) {
+        return osciloscopio_iniciar(canal, canal_joystick);
+    }
+    canal_sinal = canal;
+    return true;
+}
+
+uint osciloscopio_canal(void) {
+    return canal_sinal;
+}
+
+void osciloscopio_definir_gatilho(BordaGatilho borda_nova, uint16_t nivel_novo) {
+    borda = borda_nova < TOTAL_GATILHOS ? borda_nova : GATILHO_LIVRE;
+    nivel = nivel_novo > OSC_NIVEL_MAXIMO ? OSC_NIVEL_MAXIMO : nivel_novo;
+}
+
+BordaGatilho osciloscopio_borda(void) {
+    return borda;
+}
+
+uint16_t osciloscopio_nivel(void) {
+    return nivel;
+}
+
+void osciloscopio_definir_colunas_por_amostra(float colunas) {
+    if (colunas > OSC_COLUNAS) {
+        colunas = OSC_COLUNAS;
+    }
+    uint32_t q16 = (uint32_t)(colunas * 65536.0f);
+    colunas_por_amostra_q16 = q16 > 0 ? q16 : 1;
+}
+
+const QuadroOsciloscopio *osciloscopio_obter_quadro(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    bool novo = quadro_novo;
+    if (novo) {
+        uint8_t anterior = quadro_leitura;
+        quadro_leitura = quadro_pronto;
+        quadro_pronto = anterior;
+        quadro_novo = false;
+        estatisticas.entregues++;
+    }
+    restore_interrupts(estado);
+    return novo ? &quadros[quadro_leitura] : NULL;
+}
+
+bool osciloscopio_ler_canal(uint canal, uint16_t *leitura) {
+    if (!ativo) {
+        return false;
+    }
+    if (canal == canal_sinal) {
+        *leitura = ultima_amostra_sinal;
+        return true;
+    }
+    if (passo_amostras == 2 && canal == canal_joystick) {
+        *leitura = ultima_amostra_joystick;
+        return true;
+    }
+    return false;
+}
+
+const EstatisticasOsciloscopio *osciloscopio_estatisticas(void) {
+    return &estatisticas;
+}
+
+void osciloscopio_zerar_estatisticas(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    estatisticas = (EstatisticasOsciloscopio){0};
+    restore_interrupts(estado);
+}
@@ -0,0 +1,76 @@
+#ifndef OSCILOSCOPIO_H
+#define OSCILOSCOPIO_H
+
+#include "pico/stdlib.h"
+
+// Captura contínua de um canal do ADC para o modo osciloscópio. O ADC roda
+// livre e dois canais DMA encadeados enchem dois blocos alternadamente; a
+// interrupção de fim de bloco procura a borda do gatilho e reduz as amostras
+// a mínimo e máximo por coluna, então nenhuma amostra depende do laço
+// principal. O joystick continua legível: se o canal do sinal for outro, o
+// ADC alterna entre os dois (round robin) e a taxa do sinal cai pela metade.
+#define OSC_AMOSTRAS_BLOCO 1024           // Amostras por bloco (2 KiB, potência de 2 para o anel do DMA)
+#define OSC_COLUNAS 128                   // Colunas do quadro (largura do display)
+#define OSC_TAXA_ADC_MAXIMA 500000u       // Conversões por segundo do ADC (96 ciclos de 48 MHz)
+#define OSC_TAXA_MINIMA 100u
+#define OSC_NIVEL_MAXIMO 4095u
+#define OSC_TENSAO_REFERENCIA 3.3f
+#define OSC_TAXA_PADRAO 100000u
+#define OSC_CANAL_PADRAO 2                // GPIO 28 (microfone da BitDogLab)
+#define OSC_NIVEL_PADRAO 2048u
+
+typedef enum {
+    GATILHO_SUBIDA,
+    GATILHO_DESCIDA,
+    GATILHO_LIVRE,
+    TOTAL_GATILHOS
+} BordaGatilho;
+
+// Mínimo e máximo (em unidades do ADC) das amostras de cada coluna, a partir
+// da borda do gatilho
+typedef struct {
+    uint16_t minimo[OSC_COLUNAS];
+    uint16_t maximo[OSC_COLUNAS];
+    bool disparado;               // false: quadro do modo automático (sem borda)
+    uint32_t taxa;                // Base de tempo com que o quadro foi reduzido
+    uint32_t colunas_por_amostra_q16;
+    uint32_t sequencia;
+} QuadroOsciloscopio;
+
+typedef struct {
+    uint32_t blocos;              // Blocos processados
+    uint32_t atrasos;             // Blocos tratados depois de o DMA voltar a eles (amostras perdidas)
+    uint32_t quadros;             // Quadros completos publicados
+    uint32_t entregues;           // Quadros levados pelo laço principal (os demais foram substituídos)
+    uint32_t automaticos;         // Quadros sem borda dentro do prazo do modo automático
+} EstatisticasOsciloscopio;
+
+bool osciloscopio_iniciar(uint canal, uint canal_joystick);
+void osciloscopio_parar(void);
+bool osciloscopio_ativo(void);
+
+// Taxa de amostragem do sinal; devolve a taxa obtida com o divisor do ADC
+uint32_t osciloscopio_definir_taxa(uint32_t taxa_hz);
+uint32_t osciloscopio_taxa(void);
+uint32_t osciloscopio_taxa_maxima(void);
+bool osciloscopio_definir_canal(uint canal);
+uint osciloscopio_canal(void);
+
+void osciloscopio_definir_gatilho(BordaGatilho borda, uint16_t nivel);
+BordaGatilho osciloscopio_borda(void);
+uint16_t osciloscopio_nivel(void);
+
+// Colunas avançadas por amostra (base de tempo), aplicada no próximo quadro
+void osciloscopio_definir_colunas_por_amostra(float colunas);
+
+// Quadro completo mais recente ainda não entregue, ou NULL
+const QuadroOsciloscopio *osciloscopio_obter_quadro(void);
+
+// Leitura de um canal do ADC durante a captura (última amostra do bloco);
+// false se o canal não está sendo convertido
+bool osciloscopio_ler_canal(uint canal, uint16_t *leitura);
+
+const EstatisticasOsciloscopio *osciloscopio_estatisticas(void);
+void osciloscopio_zerar_estatisticas(void);
+
+#endif // OSCILOSCOPIO_H
@@ -0,0 +1,27 @@
+#include "partida.h"
+#include <stdio.h>
+
+static uint32_t instantes_us[PARTIDA_TOTAL_ETAPAS];
+
+static const char *const nomes_etapas[PARTIDA_TOTAL_ETAPAS] = {
+    "stdio",
+    "sistema",
+    "perifericos",
+    "display_configurado",
+    "primeiro_quadro",
+    "laco",
+};
+
+void partida_marcar(EtapaPartida etapa) {
+    instantes_us[etapa] = time_us_32();
+}
+
+// Instante absoluto e duração de cada etapa (desde a anterior)
+void partida_imprimir(void) {
+    uint32_t anterior = 0;
+    for (uint8_t i = 0; i < PARTIDA_TOTAL_ETAPAS; i++) {
+        printf("Partida: %-20s %7u us (+%u)\n", nomes_etapas[i],
+               (unsigned)instantes_us[i], (unsigned)(instantes_us[i] - anterior));
+        anterior = instantes_us[i];
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef PARTIDA_H
+#define PARTIDA_H
+
+#include "pico/stdlib.h"
+
+// Linha do tempo da inicialização: instante (µs desde o reset) em que cada
+// etapa terminou, do stdio até o laço principal. Impressa pela stdio ao fim
+// da partida e de novo pelo comando 'partida'.
+typedef enum {
+    PARTIDA_STDIO,              // stdio (UART e USB) iniciada
+    PARTIDA_SISTEMA,            // I2C, configuração do display disparada, camadas e PIO
+    PARTIDA_PERIFERICOS,        // Botões, ADC e PWM dos LEDs
+    PARTIDA_DISPLAY_CONFIGURADO,// Fim da espera pela configuração do display
+    PARTIDA_PRIMEIRO_QUADRO,    // Menu enviado e painel ligado
+    PARTIDA_LACO,               // Agendador e energia prontos
+    PARTIDA_TOTAL_ETAPAS
+} EtapaPartida;
+
+void partida_marcar(EtapaPartida etapa);
+void partida_imprimir(void);
+
+#endif // PARTIDA_H
@@ -0,0 +1,151 @@
+#include "perfilador.h"
+#include <stdio.h>
+
+#if PERFILADOR_ATIVO
+
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+
+typedef struct {
+    uint32_t endereco;   // 0 = entrada livre
+    uint32_t contagem;
+} EntradaHistograma;
+
+static EntradaHistograma histograma_pc[PERFILADOR_ENTRADAS_PC];
+static EntradaHistograma histograma_lr[PERFILADOR_ENTRADAS_LR];
+static volatile uint32_t amostras = 0;
+static volatile uint32_t perdidas = 0;     // Histograma cheio
+static uint32_t frequencia_atual = 0;
+
+// Tabela com endereçamento aberto; retorna false se não houver espaço
+static inline bool contar(EntradaHistograma *tabela, uint32_t mascara, uint32_t endereco) {
+    uint32_t i = ((endereco >> 1) * 2654435761u) >> 16;
+    for (uint32_t tentativas = 0; tentativas <= mascara; tentativas++) {
+        EntradaHistograma *entrada = &tabela[i & mascara];
+        if (entrada->endereco == endereco) {
+            entrada->contagem++;
+            return true;
+        }
+        if (entrada->endereco == 0) {
+            entrada->endereco = endereco;
+            entrada->contagem = 1;
+            return true;
+        }
+        i++;
+    }
+    return false;
+}
+
+// Recebe o quadro empilhado na entrada da exceção: r0-r3, r12, lr, pc, xpsr
+void __not_in_flash_func(perfilador_amostrar)(const uint32_t *quadro) {
+    amostras++;
+    if (!contar(histograma_pc, PERFILADOR_ENTRADAS_PC - 1, quadro[6])) {
+        perdidas++;
+    }
+    contar(histograma_lr, PERFILADOR_ENTRADAS_LR - 1, quadro[5] & ~1u);
+}
+
+// Escolhe a pilha ativa no momento da interrupção (bit 2 do EXC_RETURN) e
+// salta para perfilador_amostrar mantendo o LR para o retorno da exceção
+void __attribute__((naked)) isr_systick(void) {
+    __asm volatile(
+        "movs r0, #4\n"
+        "mov r1, lr\n"
+        "tst r0, r1\n"
+        "beq 1f\n"
+        "mrs r0, psp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, msp\n"
+        "2:\n"
+        "ldr r1, 3f\n"
+        "bx r1\n"
+        ".align 2\n"
+        "3: .word perfilador_amostrar\n");
+}
+
+bool perfilador_disponivel(void) {
+    return true;
+}
+
+bool perfilador_iniciar(uint32_t frequencia_hz) {
+    if (frequencia_hz == 0) {
+        return false;
+    }
+    uint32_t recarga = clock_get_hz(clk_sys) / frequencia_hz;
+    if (recarga < 2 || recarga > 0x1000000) {   // SysTick tem 24 bits
+        return false;
+    }
+    frequencia_atual = frequencia_hz;
+    systick_hw->csr = 0;
+    systick_hw->rvr = recarga - 1;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_TICKINT_BITS |
+                      M0PLUS_SYST_CSR_ENABLE_BITS;
+    return true;
+}
+
+void perfilador_parar(void) {
+    systick_hw->csr = 0;
+}
+
+void perfilador_zerar(void) {
+    uint32_t estado = save_and_disable_interrupts();
+    for (uint16_t i = 0; i < PERFILADOR_ENTRADAS_PC; i++) {
+        histograma_pc[i].endereco = 0;
+        histograma_pc[i].contagem = 0;
+    }
+    for (uint16_t i = 0; i < PERFILADOR_ENTRADAS_LR; i++) {
+        histograma_lr[i].endereco = 0;
+        histograma_lr[i].contagem = 0;
+    }
+    amostras = 0;
+    perdidas = 0;
+    restore_interrupts(estado);
+}
+
+// Uma linha por endereço: "pc 0x... n" / "lr 0x... n", lidas por
+// ferramentas/perfil_simbolos.py. A amostragem fica pausada durante o despejo.
+void perfilador_despejar(void) {
+    bool ativo = systick_hw->csr & M0PLUS_SYST_CSR_ENABLE_BITS;
+    perfilador_parar();
+
+    printf("perfil amostras=%u perdidas=%u hz=%u\n",
+           (unsigned)amostras, (unsigned)perdidas, (unsigned)frequencia_atual);
+    for (uint16_t i = 0; i < PERFILADOR_ENTRADAS_PC; i++) {
+        if (histograma_pc[i].endereco != 0) {
+            printf("pc 0x%08x %u\n", (unsigned)histograma_pc[i].endereco, (unsigned)histograma_pc[i].contagem);
+        }
+    }
+    for (uint16_t i = 0; i < PERFILADOR_ENTRADAS_LR; i++) {
+        if (histograma_lr[i].endereco != 0) {
+            printf("lr 0x%08x %u\n", (unsigned)histograma_lr[i].endereco, (unsigned)histograma_lr[i].contagem);
+        }
+    }
+
+    if (ativo) {
+        systick_hw->csr |= M0PLUS_SYST_CSR_ENABLE_BITS;
+    }
+}
+
+#else
+
+bool perfilador_disponivel(void) {
+    return false;
+}
+
+bool perfilador_iniciar(uint32_t frequencia_hz) {
+    return false;
+}
+
+void perfilador_parar(void) {
+}
+
+void perfilador_zerar(void) {
+}
+
+void perfilador_despejar(void) {
+}
+
+#endif // PERFILADOR_ATIVO
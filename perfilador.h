@@ -0,0 +1,23 @@
+#ifndef PERFILADOR_H
+#define PERFILADOR_H
+
+#include "pico/stdlib.h"
+
+// Perfilador estatístico: a interrupção do SysTick registra o PC e o LR do
+// código interrompido em histogramas na RAM. Só é compilado com a opção
+// PERFILADOR do CMake (PERFILADOR_ATIVO=1).
+#ifndef PERFILADOR_ATIVO
+#define PERFILADOR_ATIVO 0
+#endif
+
+#define PERFILADOR_FREQUENCIA_PADRAO_HZ 1009   // Primo: não sincroniza com os laços periódicos
+#define PERFILADOR_ENTRADAS_PC 512             // Endereços distintos guardados (potência de 2)
+#define PERFILADOR_ENTRADAS_LR 256
+
+bool perfilador_disponivel(void);
+bool perfilador_iniciar(uint32_t frequencia_hz);
+void perfilador_parar(void);
+void perfilador_zerar(void);
+void perfilador_despejar(void);
+
+#endif // PERFILADOR_H
@@ -0,0 +1,55 @@
+#include "rastro.h"
+#include "hardware/sync.h"
+#include "transmissao_usb.h"
+
+static EventoRastro eventos[RASTRO_CAPACIDADE];
+static volatile uint32_t total = 0;       // Eventos já registrados (o índice é total % capacidade)
+static volatile bool habilitado = true;
+
+// O RP2040 (Cortex-M0+) não tem LDREX/STREX: a reserva da posição e a escrita
+// ficam numa janela curta com interrupções mascaradas, sem espera por trava.
+void __not_in_flash_func(rastro_registrar)(TipoRastro tipo, uint8_t argumento, uint16_t valor) {
+    if (!habilitado) {
+        return;
+    }
+    uint32_t estado = save_and_disable_interrupts();
+    EventoRastro *evento = &eventos[total & (RASTRO_CAPACIDADE - 1)];
+    evento->instante_us = time_us_32();
+    evento->tipo = tipo;
+    evento->argumento = argumento;
+    evento->valor = valor;
+    total++;
+    restore_interrupts(estado);
+}
+
+void rastro_habilitar(bool habilitar) {
+    habilitado = habilitar;
+}
+
+bool rastro_habilitado(void) {
+    return habilitado;
+}
+
+// Quadro QUADRO_RASTRO: total registrado (4) | quantidade (2) | eventos do mais
+// antigo ao mais novo. A gravação fica pausada durante o envio.
+void rastro_despejar(void) {
+    bool estava_habilitado = habilitado;
+    habilitado = false;
+
+    uint32_t registrados = total;
+    uint16_t quantidade = registrados < RASTRO_CAPACIDADE ? registrados : RASTRO_CAPACIDADE;
+    uint16_t inicio = (registrados - quantidade) & (RASTRO_CAPACIDADE - 1);
+    uint16_t primeira_parte = quantidade < RASTRO_CAPACIDADE - inicio ? quantidade : RASTRO_CAPACIDADE - inicio;
+
+    uint8_t cabecalho[6] = {
+        registrados & 0xFF, (registrados >> 8) & 0xFF, (registrados >> 16) & 0xFF, registrados >> 24,
+        quantidade & 0xFF, quantidade >> 8
+    };
+    transmissao_iniciar_quadro(QUADRO_RASTRO, sizeof(cabecalho) + quantidade * sizeof(EventoRastro));
+    transmissao_enviar_bytes(cabecalho, sizeof(cabecalho));
+    transmissao_enviar_bytes((const uint8_t *)&eventos[inicio], primeira_parte * sizeof(EventoRastro));
+    transmissao_enviar_bytes((const uint8_t *)&eventos[0], (quantidade - primeira_parte) * sizeof(EventoRastro));
+    transmissao_finalizar_quadro();
+
+    habilitado = estava_habilitado;
+}
@@ -0,0 +1,36 @@
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include "pico/stdlib.h"
+
+// Rastro de eventos com instante em µs, gravado em um buffer circular de
+// tamanho fixo (os mais antigos são sobrescritos). Barato o bastante para
+// ficar sempre ligado; exportado pela USB com o comando 'rastro despejar' e
+// convertido para o formato do Chrome por ferramentas/rastro_chrome.py.
+#define RASTRO_CAPACIDADE 1024   // Eventos guardados (potência de 2)
+
+typedef enum {
+    RASTRO_ESTADO = 1,          // argumento = novo EstadoSistema
+    RASTRO_GPIO_ENTRADA,        // argumento = pino, valor = bordas (GPIO_IRQ_EDGE_*)
+    RASTRO_GPIO_SAIDA,
+    RASTRO_RENDER_INICIO,       // argumento = tela (EstadoSistema), valor = função
+    RASTRO_RENDER_FIM,
+    RASTRO_ENVIO_INICIO,        // Envio ao display (argumento = subquadro de cinza)
+    RASTRO_ENVIO_FIM,           // valor = bytes escritos no I2C
+    RASTRO_ADC                  // argumento = canal, valor = leitura
+} TipoRastro;
+
+// Formato exportado (little-endian, 8 bytes por evento)
+typedef struct {
+    uint32_t instante_us;
+    uint8_t tipo;
+    uint8_t argumento;
+    uint16_t valor;
+} EventoRastro;
+
+void rastro_registrar(TipoRastro tipo, uint8_t argumento, uint16_t valor);
+void rastro_habilitar(bool habilitar);
+bool rastro_habilitado(void);
+void rastro_despejar(void);
+
+#endif // RASTRO_H
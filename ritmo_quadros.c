@@ -0,0 +1,44 @@
+#include "ritmo_quadros.h"
+
+void ritmo_iniciar(RitmoQuadros *ritmo, uint32_t quadros_por_segundo) {
+    ritmo->periodo_us = 1000000 / quadros_por_segundo;
+    ritmo->proximo = get_absolute_time();
+    ritmo_zerar_estatisticas(ritmo);
+}
+
+void ritmo_zerar_estatisticas(RitmoQuadros *ritmo) {
+    ritmo->quadros = 0;
+    ritmo->descartados = 0;
+    ritmo->estouros = 0;
+    ritmo->duracao_max_us = 0;
+    ritmo->duracao_total_us = 0;
+}
+
+// Segura até o prazo do próximo quadro. Se o prazo já passou, descarta os
+// quadros perdidos em vez de acumular atraso. Retorna quantos períodos o
+// quadro atual representa (1 quando está em dia).
+uint32_t ritmo_aguardar_quadro(RitmoQuadros *ritmo) {
+    absolute_time_t agora = get_absolute_time();
+    int64_t atraso_us = absolute_time_diff_us(ritmo->proximo, agora);
+
+    if (atraso_us < 0) {
+        sleep_until(ritmo->proximo);
+        atraso_us = 0;
+    }
+
+    uint32_t periodos = 1 + (uint32_t)(atraso_us / ritmo->periodo_us);
+    ritmo->descartados += periodos - 1;
+    ritmo->proximo = delayed_by_us(ritmo->proximo, (uint64_t)periodos * ritmo->periodo_us);
+    return periodos;
+}
+
+void ritmo_registrar_quadro(RitmoQuadros *ritmo, uint32_t duracao_us) {
+    ritmo->quadros++;
+    ritmo->duracao_total_us += duracao_us;
+    if (duracao_us > ritmo->duracao_max_us) {
+        ritmo->duracao_max_us = duracao_us;
+    }
+    if (duracao_us > ritmo->periodo_us) {
+        ritmo->estouros++;
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef RITMO_QUADROS_H
+#define RITMO_QUADROS_H
+
+#include "pico/stdlib.h"
+
+// Cadência de quadros com orçamento fixo de tempo por quadro
+typedef struct {
+    uint32_t periodo_us;          // Orçamento de cada quadro
+    absolute_time_t proximo;      // Prazo do próximo quadro
+    uint32_t quadros;             // Quadros renderizados
+    uint32_t descartados;         // Quadros pulados para recuperar atraso
+    uint32_t estouros;            // Quadros cuja renderização excedeu o orçamento
+    uint32_t duracao_max_us;      // Maior tempo de renderização + envio
+    uint64_t duracao_total_us;
+} RitmoQuadros;
+
+void ritmo_iniciar(RitmoQuadros *ritmo, uint32_t quadros_por_segundo);
+void ritmo_zerar_estatisticas(RitmoQuadros *ritmo);
+uint32_t ritmo_aguardar_quadro(RitmoQuadros *ritmo);
+void ritmo_registrar_quadro(RitmoQuadros *ritmo, uint32_t duracao_us);
+
+#endif // RITMO_QUADROS_H
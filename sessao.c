@@ -0,0 +1,352 @@
+#include "sessao.h"
+#include <stdio.h>
+#include "hardware/adc.h"
+#include "agendador.h"
+#include "energia.h"
+#include "escala_cinza.h"
+#include "osciloscopio.h"
+#include "Display_Bibliotecas/texto.h"
+
+typedef enum {
+    SESSAO_PARADA,
+    SESSAO_GRAVANDO,
+    SESSAO_REPRODUZINDO
+} ModoSessao;
+
+static RegistroEntrada registros[SESSAO_CAPACIDADE];
+static uint16_t quantidade = 0;
+static uint32_t duracao_us = 0;
+static uint32_t perdidos = 0;          // Entradas que não couberam na gravação
+static EstadoInicialSessao inicio;
+static ModoSessao modo = SESSAO_PARADA;
+static absolute_time_t referencia;     // Instante zero da gravação/reprodução
+
+// Reprodução: eventos seguem o tempo gravado; leituras do ADC seguem a ordem
+// gravada a partir do último evento consumido
+static uint16_t cursor = 0;
+static uint16_t cursor_adc = 0;
+static uint16_t ultima_leitura = 2048;
+
+// Medidas da reprodução
+static uint32_t quadros = 0;
+static uint64_t render_total_us = 0;
+static uint32_t render_max_us = 0;
+static uint32_t bytes_inicio = 0;
+static uint32_t transacoes_inicio = 0;
+
+static uint32_t agora_us(void) {
+    return (uint32_t)absolute_time_diff_us(referencia, get_absolute_time());
+}
+
+static void gravar(TipoEntrada tipo, uint8_t argumento, uint16_t valor) {
+    if (quantidade >= SESSAO_CAPACIDADE) {
+        perdidos++;
+        return;
+    }
+    RegistroEntrada *registro = &registros[quantidade++];
+    registro->instante_us = agora_us();
+    registro->tipo = tipo;
+    registro->argumento = argumento;
+    registro->valor = valor;
+}
+
+void sessao_gravar(Sistema *sistema) {
+    inicio.estado = sistema->estado_atual;
+    inicio.funcao = sistema->funcao_selecionada;
+    inicio.indice_parametro = sistema->indice_parametro_atual;
+    for (uint8_t i = 0; i < 4; i++) {
+        inicio.parametros[i] = sistema->parametros[i];
+    }
+    inicio.zoom = sistema->nivel_zoom;
+    inicio.centro_x = sistema->posicao_central_x;
+    inicio.centro_y = sistema->posicao_central_y;
+    inicio.escala_y = sistema->fator_escala_y;
+    inicio.cursor_ativo = sistema->cursor_ativo;
+    inicio.cursor_coluna = sistema->cursor_coluna;
+    inicio.analise_ativa = sistema->analise.ativa;
+    inicio.analise_x_inicio = sistema->analise.x_inicio;
+    inicio.analise_x_fim = sistema->analise.x_fim;
+    inicio.indice_passo_tabela = sistema->tabela.indice_passo;
+    inicio.osc_canal = osciloscopio_canal();
+    inicio.osc_taxa = osciloscopio_taxa();
+    inicio.osc_borda = osciloscopio_borda();
+    inicio.osc_nivel = osciloscopio_nivel();
+
+    quantidade = 0;
+    perdidos = 0;
+    referencia = get_absolute_time();
+    modo = SESSAO_GRAVANDO;
+}
+
+void sessao_parar(void) {
+    if (modo == SESSAO_GRAVANDO) {
+        duracao_us = agora_us();
+    }
+    modo = SESSAO_PARADA;
+}
+
+bool sessao_gravando(void) {
+    return modo == SESSAO_GRAVANDO;
+}
+
+bool sessao_reproduzindo(void) {
+    return modo == SESSAO_REPRODUZINDO;
+}
+
+// Restaura o estado do início da gravação, redesenha a tela e zera as medidas
+void sessao_reproduzir(Sistema *sistema) {
+    parar_animacao(sistema);
+    definir_escala_cinza(sistema, false);
+    energia_registrar_atividade(sistema);
+
+    sistema->funcao_selecionada = inicio.funcao;
+    sistema->indice_parametro_atual = inicio.indice_parametro;
+    for (uint8_t i = 0; i < 4; i++) {
+        sistema->parametros[i] = inicio.parametros[i];
+    }
+    sistema->nivel_zoom = inicio.zoom;
+    sistema->posicao_central_x = inicio.centro_x;
+    sistema->posicao_central_y = inicio.centro_y;
+    sistema->fator_escala_y = inicio.escala_y;
+    bool cartesiana = funcao_cartesiana(inicio.funcao);
+    sistema->cursor_ativo = inicio.cursor_ativo && cartesiana;
+    sistema->cursor_coluna = inicio.cursor_coluna < SSD1306_LARGURA ? inicio.cursor_coluna : SSD1306_LARGURA / 2;
+    sistema->analise.ativa = inicio.analise_ativa && cartesiana;
+    sistema->analise.x_inicio = inicio.analise_x_inicio;
+    sistema->analise.x_fim = inicio.analise_x_fim;
+    sistema->tabela.indice_passo = inicio.indice_passo_tabela;
+    invalidar_hud();
+    definir_estado(sistema, inicio.estado);
+    // A taxa máxima depende do canal (entrelaçado ou não com o joystick)
+    osciloscopio_definir_canal(inicio.osc_canal);
+    osciloscopio_definir_taxa(inicio.osc_taxa);
+    osciloscopio_definir_gatilho((BordaGatilho)inicio.osc_borda, inicio.osc_nivel);
+    atualizar_cores_rgb();
+    atualizar_brilho_zoom();
+
+    switch (inicio.estado) {
+        case ESTADO_MENU:
+            desenhar_tela_menu(sistema);
+            break;
+        case ESTADO_CONFIGURAR_PARAMETROS:
+            desenhar_tela_configuracao_parametros(sistema);
+            break;
+        case ESTADO_EXIBIR_GRAFICO:
+            plotar_grafico_selecionado(sistema);
+            break;
+        case ESTADO_EXIBIR_VALORES:
+            desenhar_tela_valores_quadratica(sistema);
+            break;
+        case ESTADO_EXIBIR_TABELA:
+            iniciar_tabela(sistema);
+            break;
+        case ESTADO_OSCILOSCOPIO:
+            iniciar_osciloscopio(sistema);
+            break;
+    }
+
+    cursor = 0;
+    cursor_adc = 0;
+    ultima_leitura = 2048;
+    quadros = 0;
+    render_total_us = 0;
+    render_max_us = 0;
+    bytes_inicio = sistema->tela.bytes_enviados;
+    transacoes_inicio = sistema->tela.transacoes;
+    referencia = get_absolute_time();
+    modo = SESSAO_REPRODUZINDO;
+}
+
+// Leituras do ADC não são eventos: o cursor de eventos passa por cima delas
+static void pular_leituras(void) {
+    while (cursor < quantidade && registros[cursor].tipo == ENTRADA_ADC) {
+        cursor++;
+    }
+}
+
+static bool evento_vencido(void) {
+    pular_leituras();
+    return cursor < quantidade && registros[cursor].instante_us <= agora_us();
+}
+
+// Consome o evento atual e alinha as leituras do ADC logo após ele
+static const RegistroEntrada *consumir_evento(void) {
+    const RegistroEntrada *registro = &registros[cursor++];
+    cursor_adc = cursor;
+    return registro;
+}
+
+// Prazo do agendador: o menor entre o pedido e o próximo evento gravado
+int64_t sessao_prazo_us(int64_t prazo_us) {
+    if (modo != SESSAO_REPRODUZINDO) {
+        return prazo_us;
+    }
+    pular_leituras();
+    uint32_t alvo = cursor < quantidade ? registros[cursor].instante_us : duracao_us;
+    int64_t restante = (int64_t)alvo - (int64_t)agora_us();
+    if (restante < 0) {
+        restante = 0;
+    }
+    return (prazo_us < 0 || restante < prazo_us) ? restante : prazo_us;
+}
+
+// Grava os eventos do joystick tratados pelo laço; na reprodução troca as
+// entradas reais pelas gravadas
+uint32_t sessao_filtrar_eventos(uint32_t eventos) {
+    if (modo == SESSAO_GRAVANDO) {
+        if (eventos & EVENTO_JOYSTICK) {
+            gravar(ENTRADA_JOYSTICK, 0, 0);
+        }
+        return eventos;
+    }
+    if (modo != SESSAO_REPRODUZINDO) {
+        return eventos;
+    }
+
+    botoes_descartar_eventos();
+    eventos &= ~(EVENTO_BOTAO | EVENTO_JOYSTICK);
+    if (evento_vencido()) {
+        if (registros[cursor].tipo == ENTRADA_JOYSTICK) {
+            consumir_evento();
+            eventos |= EVENTO_JOYSTICK;
+        } else {
+            eventos |= EVENTO_BOTAO;  // Retirado por sessao_proximo_botao
+        }
+    }
+    return eventos;
+}
+
+bool sessao_proximo_botao(EventoBotao *evento) {
+    if (modo == SESSAO_REPRODUZINDO) {
+        if (!evento_vencido() || registros[cursor].tipo != ENTRADA_BOTAO) {
+            return false;
+        }
+        const RegistroEntrada *registro = consumir_evento();
+        evento->pino = registro->argumento;
+        evento->tipo = (TipoEventoBotao)(registro->valor & 0x0F);
+        evento->repeticoes = registro->valor >> 4;
+        return true;
+    }
+
+    if (!botoes_proximo_evento(evento)) {
+        return false;
+    }
+    if (modo == SESSAO_GRAVANDO) {
+        uint16_t repeticoes = evento->repeticoes < 0x0FFF ? evento->repeticoes : 0x0FFF;
+        gravar(ENTRADA_BOTAO, evento->pino, evento->tipo | (repeticoes << 4));
+    }
+    return true;
+}
+
+// Na reprodução devolve as leituras gravadas em ordem até o próximo evento;
+// depois disso repete a última
+uint16_t sessao_ler_adc(uint canal) {
+    if (modo == SESSAO_REPRODUZINDO) {
+        if (cursor_adc < quantidade && registros[cursor_adc].tipo == ENTRADA_ADC) {
+            ultima_leitura = registros[cursor_adc++].valor;
+        }
+        return ultima_leitura;
+    }
+
+    uint16_t leitura;
+    if (!osciloscopio_ler_canal(canal, &leitura)) {  // Durante a captura o ADC roda livre
+        adc_select_input(canal);
+        leitura = adc_read();
+    }
+    if (modo == SESSAO_GRAVANDO) {
+        gravar(ENTRADA_ADC, canal, leitura);
+    }
+    return leitura;
+}
+
+void sessao_contar_quadro(uint32_t duracao) {
+    if (modo != SESSAO_REPRODUZINDO) {
+        return;
+    }
+    quadros++;
+    render_total_us += duracao;
+    if (duracao > render_max_us) {
+        render_max_us = duracao;
+    }
+}
+
+// Encerra a reprodução depois do último evento e da duração gravada
+void sessao_verificar_fim(Sistema *sistema) {
+    if (modo != SESSAO_REPRODUZINDO) {
+        return;
+    }
+    pular_leituras();
+    if (cursor < quantidade || agora_us() < duracao_us) {
+        return;
+    }
+    modo = SESSAO_PARADA;
+    printf("reproducao fim registros=%u duracao_us=%u quadros=%u render_us_total=%u render_us_medio=%u "
+           "render_us_max=%u i2c_bytes=%u i2c_transacoes=%u\n",
+           (unsigned)quantidade, (unsigned)duracao_us, (unsigned)quadros, (unsigned)render_total_us,
+           (unsigned)(quadros ? render_total_us / quadros : 0), (unsigned)render_max_us,
+           (unsigned)(sistema->tela.bytes_enviados - bytes_inicio),
+           (unsigned)(sistema->tela.transacoes - transacoes_inicio));
+}
+
+void sessao_despejar(void) {
+    printf("sessao inicio %d %d %d %s %s %s %s %s %s\n",
+           inicio.estado, inicio.funcao, inicio.indice_parametro,
+           texto_decimal(inicio.parametros[0], 3), texto_decimal(inicio.parametros[1], 3),
+           texto_decimal(inicio.parametros[2], 3), texto_decimal(inicio.parametros[3], 3),
+           texto_decimal(inicio.zoom, 3), texto_decimal(inicio.centro_x, 3));
+    printf("sessao vista %s %s %d %u %d %s %s %u\n", texto_decimal(inicio.centro_y, 3),
+           texto_decimal(inicio.escala_y, 3), inicio.cursor_ativo, inicio.cursor_coluna, inicio.analise_ativa,
+           texto_decimal(inicio.analise_x_inicio, 3), texto_decimal(inicio.analise_x_fim, 3),
+           inicio.indice_passo_tabela);
+    printf("sessao captura %u %u %u %u\n", inicio.osc_canal, (unsigned)inicio.osc_taxa,
+           inicio.osc_borda, inicio.osc_nivel);
+    for (uint16_t i = 0; i < quantidade; i++) {
+        printf("sessao entrada %u %u %u %u\n", (unsigned)registros[i].instante_us,
+               registros[i].tipo, registros[i].argumento, registros[i].valor);
+    }
+    printf("sessao duracao %u\n", (unsigned)duracao_us);
+    if (perdidos > 0) {
+        printf("aviso %u entradas nao couberam na gravacao\n", (unsigned)perdidos);
+    }
+}
+
+// Despejos sem as linhas "sessao vista" e "sessao captura" reproduzem com
+// a vista e a captura padrão
+void sessao_limpar(void) {
+    modo = SESSAO_PARADA;
+    quantidade = 0;
+    perdidos = 0;
+    duracao_us = 0;
+    inicio.centro_y = 0.0f;
+    inicio.escala_y = 1.0f;
+    inicio.cursor_ativo = false;
+    inicio.cursor_coluna = SSD1306_LARGURA / 2;
+    inicio.analise_ativa = false;
+    inicio.analise_x_inicio = 0.0f;
+    inicio.analise_x_fim = 0.0f;
+    inicio.indice_passo_tabela = TABELA_PASSO_PADRAO;
+    inicio.osc_canal = OSC_CANAL_PADRAO;
+    inicio.osc_taxa = OSC_TAXA_PADRAO;
+    inicio.osc_borda = GATILHO_SUBIDA;
+    inicio.osc_nivel = OSC_NIVEL_PADRAO;
+}
+
+const EstadoInicialSessao *sessao_inicio(void) {
+    return &inicio;
+}
+
+void sessao_definir_inicio(const EstadoInicialSessao *estado) {
+    inicio = *estado;
+}
+
+bool sessao_adicionar(const RegistroEntrada *registro) {
+    if (quantidade >= SESSAO_CAPACIDADE) {
+        return false;
+    }
+    registros[quantidade++] = *registro;
+    return true;
+}
+
+void sessao_definir_duracao(uint32_t duracao) {
+    duracao_us = duracao;
+}
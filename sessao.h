@@ -0,0 +1,74 @@
+#ifndef SESSAO_H
+#define SESSAO_H
+
+#include "pico/stdlib.h"
+#include "funcoes_graficas.h"
+#include "botoes.h"
+
+// Gravação e reprodução das entradas consumidas pela máquina de estados
+// (eventos dos botões, eventos do joystick e leituras do ADC), com o instante
+// relativo ao início da gravação. A reprodução injeta a mesma sequência no
+// laço principal e informa o custo dos quadros desenhados.
+#define SESSAO_CAPACIDADE 2048
+
+typedef enum {
+    ENTRADA_BOTAO = 1,      // argumento = pino, valor = tipo | repetições << 4
+    ENTRADA_JOYSTICK,       // Evento do agendador tratado pelo laço
+    ENTRADA_ADC             // argumento = canal, valor = leitura
+} TipoEntrada;
+
+typedef struct {
+    uint32_t instante_us;
+    uint8_t tipo;
+    uint8_t argumento;
+    uint16_t valor;
+} RegistroEntrada;
+
+// Estado restaurado antes de reproduzir, incluindo a vista, para que o custo
+// dos quadros não dependa do que ficou na tela
+typedef struct {
+    EstadoSistema estado;
+    TipoFuncao funcao;
+    uint8_t indice_parametro;
+    float parametros[4];
+    float zoom;
+    float centro_x;
+    float centro_y;
+    float escala_y;
+    bool cursor_ativo;
+    uint8_t cursor_coluna;
+    bool analise_ativa;
+    float analise_x_inicio;
+    float analise_x_fim;
+    uint8_t indice_passo_tabela;
+    uint8_t osc_canal;          // Captura do osciloscópio
+    uint32_t osc_taxa;
+    uint8_t osc_borda;
+    uint16_t osc_nivel;
+} EstadoInicialSessao;
+
+// Início e fim de gravação/reprodução
+void sessao_gravar(Sistema *sistema);
+void sessao_reproduzir(Sistema *sistema);
+void sessao_parar(void);
+bool sessao_gravando(void);
+bool sessao_reproduzindo(void);
+
+// Pontos de entrada usados pelo laço principal e pelos estados
+int64_t sessao_prazo_us(int64_t prazo_us);
+uint32_t sessao_filtrar_eventos(uint32_t eventos);
+bool sessao_proximo_botao(EventoBotao *evento);
+uint16_t sessao_ler_adc(uint canal);
+void sessao_contar_quadro(uint32_t duracao_us);
+void sessao_verificar_fim(Sistema *sistema);
+
+// Exportação e carga em texto: o despejo gera linhas de comando "sessao ..."
+// que, reenviadas depois de "sessao carregar", recriam a gravação
+void sessao_despejar(void);
+void sessao_limpar(void);
+const EstadoInicialSessao *sessao_inicio(void);
+void sessao_definir_inicio(const EstadoInicialSessao *estado);
+bool sessao_adicionar(const RegistroEntrada *registro);
+void sessao_definir_duracao(uint32_t duracao_us);
+
+#endif // SESSAO_H
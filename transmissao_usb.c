@@ -0,0 +1,151 @@
+#include "transmissao_usb.h"
+#include <string.h>
+#include "pico/stdio_usb.h"
+
+#define TELA_BYTES (SSD1306_LARGURA * SSD1306_ALTURA / 8)
+#define REPETICAO_MINIMA 4   // Repetições a partir das quais o RLE compensa
+#define INTERVALO_MINIMO 4   // Bytes iguais que encerram um trecho literal
+#define REGISTRO_MAXIMO 128
+
+#ifndef TRANSMISSAO_USB_ATIVA
+#define TRANSMISSAO_USB_ATIVA 0
+#endif
+
+static bool habilitada = TRANSMISSAO_USB_ATIVA;
+static uint8_t sequencia = 0;
+static uint8_t quadros_desde_completo = TRANSMISSAO_INTERVALO_COMPLETO;
+static uint8_t tela_anterior[TELA_BYTES];
+
+// Soma Fletcher-16 acumulada durante o envio
+static uint16_t soma1;
+static uint16_t soma2;
+
+void transmissao_habilitar(bool habilitar) {
+    habilitada = habilitar;
+    quadros_desde_completo = TRANSMISSAO_INTERVALO_COMPLETO;  // Próximo quadro completo
+}
+
+bool transmissao_habilitada(void) {
+    return habilitada && stdio_usb_connected();
+}
+
+// Envia direto do buffer de origem, sem cópia intermediária
+void transmissao_enviar_bytes(const uint8_t *dados, uint16_t tamanho) {
+    for (uint16_t i = 0; i < tamanho; i++) {
+        soma1 = (soma1 + dados[i]) % 255;
+        soma2 = (soma2 + soma1) % 255;
+    }
+    stdio_usb.out_chars((const char *)dados, tamanho);
+}
+
+void transmissao_iniciar_quadro(TipoQuadro tipo, uint16_t comprimento) {
+    const uint8_t sincronismo[2] = {TRANSMISSAO_SINCRONISMO_0, TRANSMISSAO_SINCRONISMO_1};
+    stdio_usb.out_chars((const char *)sincronismo, sizeof(sincronismo));
+
+    soma1 = 0;
+    soma2 = 0;
+    uint8_t cabecalho[4] = {tipo, sequencia++, comprimento & 0xFF, comprimento >> 8};
+    transmissao_enviar_bytes(cabecalho, sizeof(cabecalho));
+}
+
+void transmissao_finalizar_quadro(void) {
+    uint8_t soma[2] = {soma1, soma2};
+    stdio_usb.out_chars((const char *)soma, sizeof(soma));
+}
+
+static uint16_t comprimento_repeticao(const uint8_t *atual, uint16_t i) {
+    uint16_t n = 1;
+    while (i + n < TELA_BYTES && n < REGISTRO_MAXIMO && atual[i + n] == atual[i]) {
+        n++;
+    }
+    return n;
+}
+
+static bool trecho_igual(const uint8_t *atual, uint16_t i) {
+    if (i + INTERVALO_MINIMO > TELA_BYTES) {
+        return false;
+    }
+    return memcmp(&atual[i], &tela_anterior[i], INTERVALO_MINIMO) == 0;
+}
+
+// Percorre as diferenças contra o quadro anterior. Com emitir = false apenas
+// calcula o tamanho dos dados; com emitir = true envia os registros.
+static uint16_t percorrer_delta(const uint8_t *atual, bool emitir) {
+    uint16_t total = 0;
+    uint16_t i = 0;
+
+    while (i < TELA_BYTES) {
+        if (atual[i] == tela_anterior[i]) {
+            i++;
+            continue;
+        }
+
+        uint8_t registro[3] = {i & 0xFF, i >> 8, 0};
+        uint16_t repeticao = comprimento_repeticao(atual, i);
+
+        if (repeticao >= REPETICAO_MINIMA) {
+            registro[2] = TRANSMISSAO_DELTA_RLE | (repeticao - 1);
+            if (emitir) {
+                transmissao_enviar_bytes(registro, sizeof(registro));
+                transmissao_enviar_bytes(&atual[i], 1);
+            }
+            total += sizeof(registro) + 1;
+            i += repeticao;
+            continue;
+        }
+
+        uint16_t fim = i + 1;
+        while (fim < TELA_BYTES && fim - i < REGISTRO_MAXIMO && !trecho_igual(atual, fim) &&
+               comprimento_repeticao(atual, fim) < REPETICAO_MINIMA) {
+            fim++;
+        }
+
+        registro[2] = fim - i - 1;
+        if (emitir) {
+            transmissao_enviar_bytes(registro, sizeof(registro));
+            transmissao_enviar_bytes(&atual[i], fim - i);
+        }
+        total += sizeof(registro) + (fim - i);
+        i = fim;
+    }
+    return total;
+}
+
+void transmissao_enviar_tela(const ssd1306_t *tela) {
+    if (!transmissao_habilitada() || tela->ram_buffer == NULL) {
+        return;
+    }
+
+    const uint8_t *atual = tela->ram_buffer + 1;
+
+    if (quadros_desde_completo >= TRANSMISSAO_INTERVALO_COMPLETO) {
+        transmissao_iniciar_quadro(QUADRO_TELA_COMPLETA, TELA_BYTES);
+        transmissao_enviar_bytes(atual, TELA_BYTES);
+        quadros_desde_completo = 0;
+    } else {
+        transmissao_iniciar_quadro(QUADRO_TELA_DELTA, percorrer_delta(atual, false));
+        percorrer_delta(atual, true);
+        quadros_desde_completo++;
+    }
+    transmissao_finalizar_quadro();
+
+    memcpy(tela_anterior, atual, TELA_BYTES);
+}
+
+void transmissao_enviar_amostras(const float *amostras, uint16_t quantidade, float x_inicial, float passo_x) {
+    if (!transmissao_habilitada()) {
+        return;
+    }
+
+    // Cabeçalho: quantidade (2) | x da primeira coluna (4) | passo em x (4)
+    uint8_t cabecalho[10];
+    cabecalho[0] = quantidade & 0xFF;
+    cabecalho[1] = quantidade >> 8;
+    memcpy(&cabecalho[2], &x_inicial, sizeof(float));
+    memcpy(&cabecalho[6], &passo_x, sizeof(float));
+
+    transmissao_iniciar_quadro(QUADRO_AMOSTRAS, sizeof(cabecalho) + quantidade * sizeof(float));
+    transmissao_enviar_bytes(cabecalho, sizeof(cabecalho));
+    transmissao_enviar_bytes((const uint8_t *)amostras, quantidade * sizeof(float));
+    transmissao_finalizar_quadro();
+}
@@ -0,0 +1,39 @@
+#ifndef TRANSMISSAO_USB_H
+#define TRANSMISSAO_USB_H
+
+#include "pico/stdlib.h"
+#include "Display_Bibliotecas/ssd1306.h"
+
+// Protocolo binário (todos os campos em little-endian):
+//   0xA5 0x5A | tipo (1) | sequência (1) | comprimento (2) | dados | Fletcher-16 (2)
+// O Fletcher-16 cobre tipo, sequência, comprimento e dados.
+#define TRANSMISSAO_SINCRONISMO_0 0xA5
+#define TRANSMISSAO_SINCRONISMO_1 0x5A
+
+typedef enum {
+    QUADRO_TELA_COMPLETA = 0x01,  // 1024 bytes no formato de páginas do SSD1306
+    QUADRO_TELA_DELTA = 0x02,     // Registros de diferença contra o quadro anterior
+    QUADRO_AMOSTRAS = 0x03,       // Valores y amostrados por coluna (float32)
+    QUADRO_RASTRO = 0x04          // Eventos do rastro (ver rastro.h)
+} TipoQuadro;
+
+// Registro do quadro delta: deslocamento (2) | controle (1) | dados
+//   controle bit 7 = 0: (controle + 1) bytes literais
+//   controle bit 7 = 1: (controle & 0x7F) + 1 repetições do byte seguinte
+#define TRANSMISSAO_DELTA_RLE 0x80
+
+// Quadros delta entre dois quadros completos
+#define TRANSMISSAO_INTERVALO_COMPLETO 30
+
+void transmissao_habilitar(bool habilitar);
+bool transmissao_habilitada(void);
+void transmissao_enviar_tela(const ssd1306_t *tela);
+void transmissao_enviar_amostras(const float *amostras, uint16_t quantidade, float x_inicial, float passo_x);
+
+// Quadros montados por outros módulos: iniciar, enviar exatamente
+// 'comprimento' bytes em partes e finalizar
+void transmissao_iniciar_quadro(TipoQuadro tipo, uint16_t comprimento);
+void transmissao_enviar_bytes(const uint8_t *dados, uint16_t tamanho);
+void transmissao_finalizar_quadro(void);
+
+#endif // TRANSMISSAO_USB_H